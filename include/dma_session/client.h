@@ -0,0 +1,47 @@
+/*
+ * \brief  Client-side DMA session interface
+ * \author agent
+ * \date   2026-10-18
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__DMA_SESSION__CLIENT_H_
+#define _INCLUDE__DMA_SESSION__CLIENT_H_
+
+#include <base/rpc_client.h>
+#include <dma_session/dma_session.h>
+
+namespace Dma { struct Session_client; }
+
+
+struct Dma::Session_client : Rpc_client<Session>
+{
+	explicit Session_client(Capability<Session> session)
+	: Rpc_client<Session>(session) { }
+
+	Buffer_id alloc_buffer(size_t size) override {
+		return call<Rpc_alloc_buffer>(size); }
+
+	Dataspace_capability dataspace(Buffer_id id) override {
+		return call<Rpc_dataspace>(id); }
+
+	void free_buffer(Buffer_id id) override {
+		call<Rpc_free_buffer>(id); }
+
+	void completion_sigh(Signal_context_capability sigh) override {
+		call<Rpc_completion_sigh>(sigh); }
+
+	Ticket submit(Chain const &chain) override {
+		return call<Rpc_submit>(chain); }
+
+	Status status() override {
+		return call<Rpc_status>(); }
+};
+
+#endif /* _INCLUDE__DMA_SESSION__CLIENT_H_ */
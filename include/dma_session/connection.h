@@ -0,0 +1,44 @@
+/*
+ * \brief  Connection to DMA service
+ * \author agent
+ * \date   2026-10-18
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__DMA_SESSION__CONNECTION_H_
+#define _INCLUDE__DMA_SESSION__CONNECTION_H_
+
+#include <base/connection.h>
+#include <dma_session/client.h>
+
+namespace Dma { struct Connection; }
+
+
+struct Dma::Connection : Genode::Connection<Session>, Session_client
+{
+	/*
+	 * The RAM quota covers the session meta data only, DMA buffers are
+	 * accounted separately via 'upgrade_ram()'.
+	 */
+	enum { RAM_QUOTA = 16*1024 };
+
+	Connection(Env &env, Session_label const &label = Session_label())
+	:
+		Genode::Connection<Session>(env, label, Ram_quota { RAM_QUOTA }, Args()),
+		Session_client(cap())
+	{ }
+
+	Buffer_id alloc_buffer(size_t size) override
+	{
+		return retry_with_upgrade(Ram_quota{size + 4096}, Cap_quota{2}, [&] () {
+			return Session_client::alloc_buffer(size); });
+	}
+};
+
+#endif /* _INCLUDE__DMA_SESSION__CONNECTION_H_ */
@@ -0,0 +1,148 @@
+/*
+ * \brief  DMA session interface
+ * \author agent
+ * \date   2026-10-18
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__DMA_SESSION__DMA_SESSION_H_
+#define _INCLUDE__DMA_SESSION__DMA_SESSION_H_
+
+#include <base/signal.h>
+#include <dataspace/capability.h>
+#include <session/session.h>
+
+namespace Dma {
+	using namespace Genode;
+
+	struct Session;
+}
+
+
+/*
+ * Session for offloading memory copies and fills to a DMA controller
+ *
+ * The client allocates buffers via the session and refers to them by their
+ * id in jobs. Jobs are submitted as chains, which are executed back to back
+ * without CPU involvement and complete as a whole. Chains of a session
+ * complete in the order of their submission. Each completion is signalled
+ * to the client.
+ */
+struct Dma::Session : Genode::Session
+{
+	/**
+	 * \noapi
+	 */
+	static const char *service_name() { return "Dma"; }
+
+	enum { CAP_QUOTA = 8, MAX_BUFFERS = 16, MAX_CHAIN = 8 };
+
+	struct Buffer_id { unsigned value; };
+
+	struct Job
+	{
+		enum Op { COPY, FILL };
+
+		Op        op;
+		Buffer_id dst;
+		size_t    dst_offset;
+		Buffer_id src;         /* ignored for FILL */
+		size_t    src_offset;  /* ignored for FILL */
+		size_t    len;
+		uint8_t   value;       /* fill value, ignored for COPY */
+	};
+
+	struct Chain
+	{
+		Job      jobs[MAX_CHAIN] { };
+		unsigned count           { 0 };
+
+		bool add(Job const &job)
+		{
+			if (count >= MAX_CHAIN)
+				return false;
+
+			jobs[count++] = job;
+			return true;
+		}
+	};
+
+	/*
+	 * Tickets are assigned in ascending order, ticket 0 denotes a chain
+	 * that has been rejected because it is malformed or the queue is full
+	 */
+	using Ticket = unsigned long;
+
+	struct Status
+	{
+		Ticket        completed;   /* all chains up to this ticket finished */
+		Ticket        last_error;  /* last chain that failed, 0 if none */
+		unsigned long errors;
+	};
+
+	struct Out_of_buffers : Exception { };
+
+	virtual ~Session() { }
+
+	/**
+	 * Allocate DMA buffer
+	 *
+	 * \throw Out_of_ram
+	 * \throw Out_of_caps
+	 * \throw Out_of_buffers
+	 */
+	virtual Buffer_id alloc_buffer(size_t size) = 0;
+
+	/**
+	 * Return dataspace of buffer for local access
+	 */
+	virtual Dataspace_capability dataspace(Buffer_id) = 0;
+
+	/**
+	 * Free buffer
+	 *
+	 * Queued chains that refer to the buffer fail. A running chain that
+	 * refers to the buffer is aborted and fails. Otherwise, the memory of
+	 * the buffer is released once the running chain completed.
+	 */
+	virtual void free_buffer(Buffer_id) = 0;
+
+	/**
+	 * Register signal handler notified on the completion of chains
+	 */
+	virtual void completion_sigh(Signal_context_capability) = 0;
+
+	/**
+	 * Queue chain of jobs
+	 *
+	 * \return  ticket of the chain, 0 if the chain has been rejected
+	 */
+	virtual Ticket submit(Chain const &) = 0;
+
+	virtual Status status() = 0;
+
+
+	/*******************
+	 ** RPC interface **
+	 *******************/
+
+	GENODE_RPC_THROW(Rpc_alloc_buffer, Buffer_id, alloc_buffer,
+	                 GENODE_TYPE_LIST(Out_of_ram, Out_of_caps, Out_of_buffers),
+	                 size_t);
+	GENODE_RPC(Rpc_dataspace, Dataspace_capability, dataspace, Buffer_id);
+	GENODE_RPC(Rpc_free_buffer, void, free_buffer, Buffer_id);
+	GENODE_RPC(Rpc_completion_sigh, void, completion_sigh, Signal_context_capability);
+	GENODE_RPC(Rpc_submit, Ticket, submit, Chain const &);
+	GENODE_RPC(Rpc_status, Status, status);
+
+	GENODE_RPC_INTERFACE(Rpc_alloc_buffer, Rpc_dataspace, Rpc_free_buffer,
+	                     Rpc_completion_sigh, Rpc_submit, Rpc_status);
+};
+
+#endif /* _INCLUDE__DMA_SESSION__DMA_SESSION_H_ */
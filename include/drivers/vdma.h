@@ -15,21 +15,60 @@
 #define _VDMA_H_
 
 #include <base/attached_io_mem_dataspace.h>
+#include <platform_session/device.h>
 #include <util/mmio.h>
+#include <util/reconstructible.h>
 
 namespace Vdma {
 	using namespace Genode;
+	class Zynq_Vdma_registers;
 	class Zynq_Vdma;
 }
 
-struct Vdma::Zynq_Vdma : Attached_io_mem_dataspace, Mmio
+
+/*
+ * Register window of the VDMA, either of a platform device or of a raw
+ * I/O memory range
+ */
+class Vdma::Zynq_Vdma_registers
+{
+	private:
+
+		Constructible<Platform::Device::Mmio>    _device_mmio { };
+		Constructible<Attached_io_mem_dataspace> _io_mem      { };
+
+	protected:
+
+		Zynq_Vdma_registers(Platform::Device &device) {
+			_device_mmio.construct(device); }
+
+		Zynq_Vdma_registers(Env &env, addr_t mmio_base, size_t mmio_size) {
+			_io_mem.construct(env, mmio_base, mmio_size); }
+
+		addr_t _registers_base()
+		{
+			return _device_mmio.constructed()
+			     ? (addr_t)_device_mmio->local_addr<void>()
+			     : (addr_t)_io_mem->local_addr<void>();
+		}
+};
+
+
+struct Vdma::Zynq_Vdma : private Zynq_Vdma_registers, Mmio
 {
-	Zynq_Vdma(Genode::Env &env, Genode::addr_t const mmio_base, Genode::size_t const mmio_size) :
-		Genode::Attached_io_mem_dataspace(env, mmio_base, mmio_size),
-		Genode::Mmio((Genode::addr_t)local_addr<void>())
+	enum { MAX_FRAME_STORES = 32, BANK_SIZE = 16 };
+
+	Zynq_Vdma(Platform::Device &device)
+	: Zynq_Vdma_registers(device), Mmio(_registers_base())
 	{ }
 
-	~Zynq_Vdma()
+	/**
+	 * Constructor for a VDMA at a raw I/O memory range
+	 *
+	 * Kept for drivers that do not obtain the VDMA via a platform session.
+	 */
+	Zynq_Vdma(Env &env, addr_t mmio_base, size_t mmio_size)
+	: Zynq_Vdma_registers(env, mmio_base, mmio_size), Mmio(_registers_base())
 	{ }
 
 	/*
@@ -38,8 +77,10 @@ struct Vdma::Zynq_Vdma : Attached_io_mem_dataspace, Mmio
 
 	struct MM2S_VDMACR : Register<0x00, 32>
 	{
+		struct Irq_Frame_Count : Bitfield<16,8> {};
 		struct Repeat_En     : Bitfield<15,1> {};
 		struct Err_IrqEn     : Bitfield<14,1> {};
+		struct FrmCnt_IrqEn  : Bitfield<12,1> {};
 		struct RdPntrNum     : Bitfield<8,4> {};
 		struct GenlockSrc    : Bitfield<7,1> {};
 		struct GenlockEn     : Bitfield<3,1> {};
@@ -51,6 +92,7 @@ struct Vdma::Zynq_Vdma : Attached_io_mem_dataspace, Mmio
 	struct MM2S_VDMASR : Register<0x04, 32>
 	{
 		struct Err_Irq : Bitfield<14,1> {};
+		struct FrmCnt_Irq : Bitfield<12,1> {};
 		struct SOFEarlyErr : Bitfield<7,1> {};
 		struct VDMADecErr : Bitfield<6,1> {};
 		struct VDMASlvErr : Bitfield<5,1> {};
@@ -63,6 +105,11 @@ struct Vdma::Zynq_Vdma : Attached_io_mem_dataspace, Mmio
 		struct MM2S_Reg_Index : Bitfield<0,1> {};
 	};
 
+	struct MM2S_FRMSTORE : Register<0x18, 32>
+	{
+		struct Num_Frame_Stores : Bitfield<0,6> {};
+	};
+
 	struct PARK_PTR_REG : Register<0x28, 32>
 	{
 		struct WrFrmStore : Bitfield<24,5> {};
@@ -81,18 +128,23 @@ struct Vdma::Zynq_Vdma : Attached_io_mem_dataspace, Mmio
 
 	struct S2MM_VDMACR : Register<0x30, 32>
 	{
+		struct Irq_Frame_Count : Bitfield<16,8> {};
 		struct Repeat_En : Bitfield<15,1> {};
 		struct Err_IrqEn : Bitfield<14,1> {};
+		struct FrmCnt_IrqEn : Bitfield<12,1> {};
 		struct WrPntrNum : Bitfield<8,4> {};
 		struct GenlockSrc : Bitfield<7,1> {};
 		struct GenlockEn : Bitfield<3,1> {};
 		struct Reset : Bitfield<2,1> {};
+		struct Circular_Park : Bitfield<1,1> {};
+		struct RS : Bitfield<0,1> {};
 	};
 
 	struct S2MM_VDMASR : Register<0x34, 32>
 	{
 		struct EOLLateErr : Bitfield<15,1> {};
 		struct Err_Irq : Bitfield<14,1> {};
+		struct FrmCnt_Irq : Bitfield<12,1> {};
 		struct SOFLateErr : Bitfield<11,1> {};
 		struct EOLEarlyErr : Bitfield<8,1> {};
 		struct SOFEarlyErr : Bitfield<7,1> {};
@@ -107,6 +159,11 @@ struct Vdma::Zynq_Vdma : Attached_io_mem_dataspace, Mmio
 		struct S2MM_Reg_Index : Bitfield<0,1> {};
 	};
 
+	struct S2MM_FRMSTORE : Register<0x48, 32>
+	{
+		struct Num_Frame_Stores : Bitfield<0,6> {};
+	};
+
 	struct MM2S_VSIZE : Register<0x50, 32>
 	{
 		struct Vertical_Size : Bitfield<0,13> {};
@@ -129,6 +186,9 @@ struct Vdma::Zynq_Vdma : Attached_io_mem_dataspace, Mmio
 
 	struct MM2S_START_ADDRESS : Register<0x5c, 32> {};
 
+	/* frame stores 16..31 are selected via MM2S_REG_INDEX */
+	struct MM2S_Framebuffer : Register_array<0x5c, 32, BANK_SIZE, 32> {};
+
 	struct S2MM_VSIZE : Register<0xa0, 32>
 	{
 		struct Vertical_Size : Bitfield<0,13> {};
@@ -147,6 +207,58 @@ struct Vdma::Zynq_Vdma : Attached_io_mem_dataspace, Mmio
 
 	struct S2MM_START_ADDRESS : Register<0xac, 32> {};
 
+	/* frame stores 16..31 are selected via S2MM_REG_INDEX */
+	struct S2MM_Framebuffer : Register_array<0xac, 32, BANK_SIZE, 32> {};
+
+	/*
+	 * Helpers
+	 */
+
+	bool mm2s_reset(Delayer &delayer)
+	{
+		write<MM2S_VDMACR::Reset>(1);
+		for (unsigned i = 0; i < 100; i++) {
+			if (!read<MM2S_VDMACR::Reset>())
+				return true;
+			delayer.usleep(10);
+		}
+		return false;
+	}
+
+	void mm2s_frame_address(unsigned store, addr_t addr)
+	{
+		write<MM2S_REG_INDEX::MM2S_Reg_Index>(store / BANK_SIZE);
+		write<MM2S_Framebuffer>((MM2S_Framebuffer::access_t)addr, store % BANK_SIZE);
+	}
+
+	/* frame store read by the MM2S channel in park mode */
+	void mm2s_park(unsigned store) {
+		write<PARK_PTR_REG::RdFrmPtrRef>(store); }
+
+	bool s2mm_reset(Delayer &delayer)
+	{
+		write<S2MM_VDMACR::Reset>(1);
+		for (unsigned i = 0; i < 100; i++) {
+			if (!read<S2MM_VDMACR::Reset>())
+				return true;
+			delayer.usleep(10);
+		}
+		return false;
+	}
+
+	/* number of frame stores configured in the core */
+	unsigned s2mm_frame_stores() {
+		return read<S2MM_FRMSTORE::Num_Frame_Stores>(); }
+
+	void s2mm_frame_address(unsigned store, addr_t addr)
+	{
+		write<S2MM_REG_INDEX::S2MM_Reg_Index>(store / BANK_SIZE);
+		write<S2MM_Framebuffer>((S2MM_Framebuffer::access_t)addr, store % BANK_SIZE);
+	}
+
+	/* frame store currently written by the S2MM channel */
+	unsigned s2mm_current_store() {
+		return read<PARK_PTR_REG::WrFrmStore>(); }
 };
 
 #endif // _VDMA_H_
@@ -0,0 +1,256 @@
+/*
+ * \brief  Sub-allocation of DMA buffers from naturally aligned arenas
+ * \author agent
+ * \date   2026-10-18
+ *
+ * On Zynq, DMA access of PL masters is restricted by the DMA guard, which
+ * protects naturally aligned power-of-two windows with a small number of
+ * segment registers. Each 'Platform::Dma_buffer' occupies its own range and
+ * is rounded up to such a window. Drivers that use many small buffers
+ * therefore waste memory and quickly exhaust the segments. Moreover, each
+ * allocation is an RPC to the platform driver and reconfigures the guard.
+ *
+ * A 'Dma_arena' allocates power-of-two sized DMA buffers from the platform
+ * session and places the buffers of the driver into these arenas. Since
+ * core allocates RAM naturally aligned to its size if possible, each arena
+ * is covered by a single window of the guard. An arena that is not aligned
+ * to its size is requested anew, and the allocation fails with
+ * 'Unaligned_arena' if no aligned arena can be obtained.
+ */
+
+/*
+ * Copyright (C) 2023 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__PLATFORM_SESSION__DMA_ARENA_H_
+#define _INCLUDE__PLATFORM_SESSION__DMA_ARENA_H_
+
+/* Genode includes */
+#include <base/allocator_avl.h>
+#include <base/log.h>
+#include <util/list.h>
+#include <util/misc_math.h>
+#include <platform_session/connection.h>
+#include <platform_session/dma_buffer.h>
+
+namespace Platform { class Dma_arena; }
+
+
+class Platform::Dma_arena : Genode::Noncopyable
+{
+	public:
+
+		class Buffer;
+
+		enum {
+			DEFAULT_ARENA_SIZE = 256*1024,
+
+			/* keep buffers apart by a cache line of the Cortex-A9 */
+			DEFAULT_ALIGN_LOG2 = 5
+		};
+
+		struct Unaligned_arena : Genode::Exception { };
+
+	private:
+
+		using addr_t = Genode::addr_t;
+		using size_t = Genode::size_t;
+
+		/*
+		 * Buffers are allocated at offsets within their arena because
+		 * DMA address 0 is valid, e.g., on Zynq, where DDR starts at 0
+		 */
+		struct Arena : Genode::List<Arena>::Element
+		{
+			Dma_buffer            buffer;
+			Genode::Allocator_avl range_alloc;
+			size_t                used { 0 };
+
+			Arena(Connection &platform, Genode::Allocator &md_alloc,
+			      size_t size, Genode::Cache cache)
+			:
+				buffer(platform, size, cache), range_alloc(&md_alloc)
+			{
+				range_alloc.add_range(0, size);
+			}
+
+			bool aligned() const {
+				return !(buffer.dma_addr() & (buffer.size() - 1)); }
+
+			bool try_alloc(size_t size, unsigned align_log2, addr_t &offset)
+			{
+				bool ok = false;
+				range_alloc.alloc_aligned(size, align_log2).with_result(
+					[&] (void *ptr) { offset = (addr_t)ptr; ok = true; },
+					[&] (Genode::Allocator::Alloc_error) { });
+
+				if (ok)
+					used += size;
+
+				return ok;
+			}
+		};
+
+		struct Allocation
+		{
+			Arena  &arena;
+			addr_t  offset;
+		};
+
+		enum { ALIGN_ATTEMPTS = 3 };
+
+		Connection            &_platform;
+		Genode::Allocator     &_md_alloc;
+		Genode::Cache    const _cache;
+		size_t           const _arena_size;
+		Genode::List<Arena>    _arenas { };
+
+		/*
+		 * Add an arena that is naturally aligned
+		 *
+		 * Arenas that are not aligned are kept during the next attempts to
+		 * obtain a different placement.
+		 */
+		Arena &_add_arena(size_t min_size)
+		{
+			size_t size = _arena_size;
+			while (size < min_size)
+				size <<= 1;
+
+			Arena *misaligned[ALIGN_ATTEMPTS] { };
+			Arena *arena = nullptr;
+
+			for (unsigned i = 0; i < ALIGN_ATTEMPTS && !arena; i++) {
+				Arena &a = *new (_md_alloc) Arena(_platform, _md_alloc, size, _cache);
+				if (a.aligned())
+					arena = &a;
+				else
+					misaligned[i] = &a;
+			}
+
+			for (Arena *a : misaligned)
+				if (a)
+					Genode::destroy(_md_alloc, a);
+
+			if (!arena) {
+				Genode::error("unable to obtain DMA arena of ", Genode::Hex(size),
+				              " bytes aligned to its size");
+				throw Unaligned_arena();
+			}
+
+			_arenas.insert(arena);
+			return *arena;
+		}
+
+		void _release_arena(Arena &arena)
+		{
+			_arenas.remove(&arena);
+			Genode::destroy(_md_alloc, &arena);
+		}
+
+		/*
+		 * Allocate buffer, add an arena if none fits
+		 */
+		Allocation _alloc(size_t size, unsigned align_log2)
+		{
+			addr_t offset = 0;
+
+			for (Arena *a = _arenas.first(); a; a = a->next())
+				if (a->try_alloc(size, align_log2, offset))
+					return Allocation { *a, offset };
+
+			Arena &arena = _add_arena(size + (1UL << align_log2));
+			if (!arena.try_alloc(size, align_log2, offset))
+				throw Genode::Out_of_ram();
+
+			return Allocation { arena, offset };
+		}
+
+		void _free(Allocation const &allocation, size_t size)
+		{
+			Arena &arena = allocation.arena;
+
+			arena.range_alloc.free((void *)allocation.offset);
+			arena.used -= size;
+
+			/* keep one arena for subsequent allocations */
+			if (!arena.used && _arenas.first() && _arenas.first()->next())
+				_release_arena(arena);
+		}
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param md_alloc    allocator for meta data
+		 * \param cache       caching attribute of all buffers of the arena
+		 * \param arena_size  minimum size of the arenas, must be a power
+		 *                    of two
+		 */
+		Dma_arena(Connection        &platform,
+		          Genode::Allocator &md_alloc,
+		          Genode::Cache      cache,
+		          size_t             arena_size = DEFAULT_ARENA_SIZE)
+		:
+			_platform(platform), _md_alloc(md_alloc), _cache(cache),
+			_arena_size(1UL << Genode::log2(Genode::max(arena_size, 4096UL)))
+		{ }
+
+		~Dma_arena()
+		{
+			while (Arena *arena = _arenas.first())
+				_release_arena(*arena);
+		}
+
+		Genode::Cache cache() const { return _cache; }
+};
+
+
+/*
+ * DMA buffer placed in an arena, which provides the interface of
+ * 'Platform::Dma_buffer'
+ */
+class Platform::Dma_arena::Buffer : Genode::Noncopyable
+{
+	private:
+
+		Dma_arena        &_dma_arena;
+		size_t     const  _size;
+		Allocation const  _allocation;
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \throw Out_of_ram
+		 * \throw Out_of_caps
+		 * \throw Unaligned_arena
+		 */
+		Buffer(Dma_arena &dma_arena, size_t size,
+		       unsigned align_log2 = DEFAULT_ALIGN_LOG2)
+		:
+			_dma_arena(dma_arena), _size(size),
+			_allocation(dma_arena._alloc(size, align_log2))
+		{ }
+
+		~Buffer() { _dma_arena._free(_allocation, _size); }
+
+		template <typename T = void>
+		T *local_addr() const
+		{
+			return reinterpret_cast<T *>(_allocation.arena.buffer.local_addr<char>()
+			                             + _allocation.offset);
+		}
+
+		addr_t dma_addr() const {
+			return _allocation.arena.buffer.dma_addr() + _allocation.offset; }
+
+		size_t size() const { return _size; }
+};
+
+#endif /* _INCLUDE__PLATFORM_SESSION__DMA_ARENA_H_ */
@@ -0,0 +1,261 @@
+/*
+ * \brief  Lock-free single-producer/single-consumer ring
+ * \author agent
+ * \date   2026-10-18
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__UTIL__SPSC_RING_H_
+#define _INCLUDE__UTIL__SPSC_RING_H_
+
+#include <cpu/memory_barrier.h>
+#include <util/noncopyable.h>
+#include <util/lazy_array.h>
+
+namespace Genode {
+	class Spsc_ring_index;
+
+	template<typename, unsigned> class Spsc_ring;
+}
+
+
+/**
+ * Head and tail management of a ring with a power-of-two capacity
+ *
+ * Head and tail are free-running counters that are masked to obtain the
+ * slot index. The head is only modified by the producer, the tail is only
+ * modified by the consumer, which allows producer and consumer to run on
+ * different CPUs without locking. A memory barrier before publishing a new
+ * head (tail) makes sure that the slot content is written (read) before the
+ * other side observes the update.
+ */
+class Genode::Spsc_ring_index : Noncopyable
+{
+	private:
+
+		unsigned const    _mask;
+		unsigned volatile _head { 0 };
+		unsigned volatile _tail { 0 };
+
+		static unsigned _checked_mask(unsigned capacity)
+		{
+			if (!capacity || (capacity & (capacity - 1)))
+				throw Invalid_capacity();
+
+			return capacity - 1;
+		}
+
+	public:
+
+		struct Invalid_capacity : Exception { };
+
+		/**
+		 * Constructor
+		 *
+		 * \param capacity  number of slots, must be a power of two
+		 *
+		 * \throw Invalid_capacity
+		 */
+		Spsc_ring_index(unsigned capacity)
+		: _mask(_checked_mask(capacity))
+		{ }
+
+		unsigned capacity() const { return _mask + 1; }
+
+		/*
+		 * Producer side
+		 */
+
+		/* number of free slots */
+		unsigned free() const
+		{
+			unsigned const tail = _tail;
+			memory_barrier();
+			return capacity() - (_head - tail);
+		}
+
+		bool full() const { return !free(); }
+
+		/* slot index of the n-th free slot */
+		unsigned head_slot(unsigned n = 0) const { return (_head + n) & _mask; }
+
+		/* publish n slots to the consumer */
+		void produce(unsigned n = 1)
+		{
+			memory_barrier();
+			_head = _head + n;
+		}
+
+		/*
+		 * Consumer side
+		 */
+
+		/* number of occupied slots */
+		unsigned avail() const
+		{
+			unsigned const head = _head;
+			memory_barrier();
+			return head - _tail;
+		}
+
+		bool empty() const { return !avail(); }
+
+		/* slot index of the n-th occupied slot */
+		unsigned tail_slot(unsigned n = 0) const { return (_tail + n) & _mask; }
+
+		/* hand n slots back to the producer */
+		void consume(unsigned n = 1)
+		{
+			memory_barrier();
+			_tail = _tail + n;
+		}
+
+		/**
+		 * Reset head and tail
+		 *
+		 * Must only be called while neither producer nor consumer is active.
+		 */
+		void reset()
+		{
+			_head = 0;
+			_tail = 0;
+			memory_barrier();
+		}
+};
+
+
+/**
+ * Single-producer/single-consumer ring of CAPACITY objects of type T
+ *
+ * The objects are constructed once and stay at a fixed slot so that T can
+ * be a noncopyable object such as a 'Platform::Dma_buffer'. The producer
+ * fills free slots via 'produce()', the consumer processes occupied slots
+ * via 'consume()'. Slots may also be inspected via 'peek()' and handed back
+ * to the producer later via 'release()', e.g., when they are in flight.
+ */
+template <typename T, unsigned MAX>
+class Genode::Spsc_ring : Noncopyable
+{
+	private:
+
+		Lazy_array<T, MAX> _slots;
+		Spsc_ring_index    _index;
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param capacity  number of slots, must be a power of two <= MAX
+		 * \param args      arguments used for construction of each slot
+		 *
+		 * \throw Spsc_ring_index::Invalid_capacity
+		 */
+		template <typename ... ARGS>
+		Spsc_ring(unsigned capacity, ARGS &&... args)
+		: _slots(capacity, args...),
+		  _index(capacity > MAX ? 0 : capacity)
+		{ }
+
+		unsigned capacity() const { return _index.capacity(); }
+		unsigned free()     const { return _index.free(); }
+		unsigned avail()    const { return _index.avail(); }
+		bool     full()     const { return _index.full(); }
+		bool     empty()    const { return _index.empty(); }
+
+		/**
+		 * Fill up to 'max' free slots and publish them at once
+		 *
+		 * \param fn  functor called with 'T &' for each slot
+		 *
+		 * \return  number of produced slots
+		 */
+		template <typename FN>
+		unsigned produce(unsigned max, FN const &fn)
+		{
+			unsigned const n = min(max, _index.free());
+			for (unsigned i = 0; i < n; i++)
+				fn(_slots.value(_index.head_slot(i)));
+
+			if (n)
+				_index.produce(n);
+
+			return n;
+		}
+
+		/**
+		 * Call 'fn' for the next free slot without publishing it
+		 *
+		 * This allows the producer to fill a slot asynchronously, e.g., by
+		 * DMA, and to publish it via 'produce()' once it is complete.
+		 *
+		 * \return  false if no slot is free
+		 */
+		template <typename FN>
+		bool with_free_slot(FN const &fn)
+		{
+			if (!_index.free())
+				return false;
+
+			fn(_slots.value(_index.head_slot()));
+			return true;
+		}
+
+		/**
+		 * Call 'fn' for up to 'max' occupied slots without releasing them
+		 *
+		 * \return  number of visited slots
+		 */
+		template <typename FN>
+		unsigned peek(unsigned max, FN const &fn)
+		{
+			unsigned const n = min(max, _index.avail());
+			for (unsigned i = 0; i < n; i++)
+				fn(_slots.value(_index.tail_slot(i)));
+
+			return n;
+		}
+
+		/**
+		 * Hand 'n' occupied slots back to the producer
+		 */
+		void release(unsigned n)
+		{
+			_index.consume(min(n, _index.avail()));
+		}
+
+		/**
+		 * Process up to 'max' occupied slots and release them at once
+		 *
+		 * \return  number of consumed slots
+		 */
+		template <typename FN>
+		unsigned consume(unsigned max, FN const &fn)
+		{
+			unsigned const n = peek(max, fn);
+			if (n)
+				_index.consume(n);
+
+			return n;
+		}
+
+		/**
+		 * Call 'fn' for all slots regardless of their state
+		 *
+		 * Must only be called while neither producer nor consumer is active,
+		 * e.g., for initialisation.
+		 */
+		template <typename FN>
+		void for_each(FN const &fn)
+		{
+			_slots.for_each([&] (unsigned, T &obj) { fn(obj); });
+		}
+};
+
+#endif /* _INCLUDE__UTIL__SPSC_RING_H_ */
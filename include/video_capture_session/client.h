@@ -0,0 +1,47 @@
+/*
+ * \brief  Client-side video capture session interface
+ * \author agent
+ * \date   2026-10-18
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__VIDEO_CAPTURE_SESSION__CLIENT_H_
+#define _INCLUDE__VIDEO_CAPTURE_SESSION__CLIENT_H_
+
+#include <base/rpc_client.h>
+#include <video_capture_session/video_capture_session.h>
+
+namespace Video_capture { struct Session_client; }
+
+
+struct Video_capture::Session_client : Rpc_client<Session>
+{
+	explicit Session_client(Capability<Session> session)
+	: Rpc_client<Session>(session) { }
+
+	Mode mode() override {
+		return call<Rpc_mode>(); }
+
+	Dataspace_capability dataspace(unsigned id) override {
+		return call<Rpc_dataspace>(id); }
+
+	void frame_sigh(Signal_context_capability sigh) override {
+		call<Rpc_frame_sigh>(sigh); }
+
+	Frame acquire() override {
+		return call<Rpc_acquire>(); }
+
+	void release(unsigned id) override {
+		call<Rpc_release>(id); }
+
+	Stats stats() override {
+		return call<Rpc_stats>(); }
+};
+
+#endif /* _INCLUDE__VIDEO_CAPTURE_SESSION__CLIENT_H_ */
@@ -0,0 +1,35 @@
+/*
+ * \brief  Connection to video capture service
+ * \author agent
+ * \date   2026-10-18
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__VIDEO_CAPTURE_SESSION__CONNECTION_H_
+#define _INCLUDE__VIDEO_CAPTURE_SESSION__CONNECTION_H_
+
+#include <base/connection.h>
+#include <video_capture_session/client.h>
+
+namespace Video_capture { struct Connection; }
+
+
+struct Video_capture::Connection : Genode::Connection<Session>, Session_client
+{
+	/* the frame buffers are owned by the driver */
+	enum { RAM_QUOTA = 8*1024 };
+
+	Connection(Env &env, Session_label const &label = Session_label())
+	:
+		Genode::Connection<Session>(env, label, Ram_quota { RAM_QUOTA }, Args()),
+		Session_client(cap())
+	{ }
+};
+
+#endif /* _INCLUDE__VIDEO_CAPTURE_SESSION__CONNECTION_H_ */
@@ -0,0 +1,118 @@
+/*
+ * \brief  Video capture session interface
+ * \author agent
+ * \date   2026-10-18
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__VIDEO_CAPTURE_SESSION__VIDEO_CAPTURE_SESSION_H_
+#define _INCLUDE__VIDEO_CAPTURE_SESSION__VIDEO_CAPTURE_SESSION_H_
+
+#include <base/signal.h>
+#include <dataspace/capability.h>
+#include <session/session.h>
+
+namespace Video_capture {
+	using namespace Genode;
+
+	struct Session;
+}
+
+
+/*
+ * Session for receiving captured frames without copying
+ *
+ * The driver owns a pool of frame buffers. The client attaches the
+ * dataspaces of all frames once and afterwards receives completed frames by
+ * their id. An acquired frame belongs to the client until it is released,
+ * i.e., the driver does not write into the frame in the meantime. If the
+ * client holds too many frames, the driver runs out of spare buffers and
+ * drops frames.
+ */
+struct Video_capture::Session : Genode::Session
+{
+	/**
+	 * \noapi
+	 */
+	static const char *service_name() { return "Video_capture"; }
+
+	enum { CAP_QUOTA = 4, MAX_FRAMES = 32 };
+
+	struct Mode
+	{
+		unsigned width;
+		unsigned height;
+		unsigned stride;          /* bytes per line */
+		unsigned bytes_per_pixel;
+		unsigned frames;          /* number of frames in the pool */
+
+		size_t frame_size() const { return (size_t)stride * height; }
+	};
+
+	struct Frame
+	{
+		unsigned      id;
+		bool          valid;
+		unsigned long sequence;   /* number of the captured frame */
+	};
+
+	struct Stats
+	{
+		unsigned long captured;   /* frames written by the core */
+		unsigned long delivered;  /* frames handed over to the client */
+		unsigned long dropped;    /* frames discarded by the driver */
+		unsigned long late;       /* frames completed before being handled */
+		unsigned long errors;
+	};
+
+	virtual ~Session() { }
+
+	virtual Mode mode() = 0;
+
+	/**
+	 * Return dataspace of frame buffer
+	 */
+	virtual Dataspace_capability dataspace(unsigned id) = 0;
+
+	/**
+	 * Register signal handler notified whenever a frame becomes available
+	 */
+	virtual void frame_sigh(Signal_context_capability) = 0;
+
+	/**
+	 * Take ownership of the oldest completed frame
+	 *
+	 * \return  frame, which is invalid if no frame is available
+	 */
+	virtual Frame acquire() = 0;
+
+	/**
+	 * Hand frame back to the driver
+	 */
+	virtual void release(unsigned id) = 0;
+
+	virtual Stats stats() = 0;
+
+
+	/*******************
+	 ** RPC interface **
+	 *******************/
+
+	GENODE_RPC(Rpc_mode, Mode, mode);
+	GENODE_RPC(Rpc_dataspace, Dataspace_capability, dataspace, unsigned);
+	GENODE_RPC(Rpc_frame_sigh, void, frame_sigh, Signal_context_capability);
+	GENODE_RPC(Rpc_acquire, Frame, acquire);
+	GENODE_RPC(Rpc_release, void, release, unsigned);
+	GENODE_RPC(Rpc_stats, Stats, stats);
+
+	GENODE_RPC_INTERFACE(Rpc_mode, Rpc_dataspace, Rpc_frame_sigh,
+	                     Rpc_acquire, Rpc_release, Rpc_stats);
+};
+
+#endif /* _INCLUDE__VIDEO_CAPTURE_SESSION__VIDEO_CAPTURE_SESSION_H_ */
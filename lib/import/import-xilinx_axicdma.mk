@@ -0,0 +1,13 @@
+include $(call select_from_repositories,lib/import/import-xilinx_common.inc)
+
+LIBS += libc
+
+INC_DIR += $(REP_DIR)/src/include/xilinx_axicdma
+INC_DIR += $(XIL_SRC_DIR)/XilinxProcessorIPLib/drivers/axicdma/src/
+
+SRC_C += xaxicdma.c xaxicdma_bd.c xaxicdma_intr.c
+
+SRC_CC += xilinx_axicdma.cc
+
+vpath xilinx_axicdma.cc $(REP_DIR)/src/lib/xilinx_axicdma
+vpath xaxicdma%.c       $(XIL_SRC_DIR)/XilinxProcessorIPLib/drivers/axicdma/src
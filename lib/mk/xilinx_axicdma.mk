@@ -0,0 +1 @@
+# header-only lib
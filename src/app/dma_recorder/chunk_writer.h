@@ -0,0 +1,187 @@
+/*
+ * \brief  Ring of capture chunks and the thread writing them to a file
+ * \author agent
+ * \date   2026-10-18
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _CHUNK_WRITER_H_
+#define _CHUNK_WRITER_H_
+
+/* Genode includes */
+#include <base/mutex.h>
+#include <base/semaphore.h>
+#include <base/signal.h>
+#include <util/spsc_ring.h>
+#include <platform_session/dma_buffer.h>
+
+/* libc includes */
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+
+namespace Dma_recorder {
+	using namespace Genode;
+
+	struct Chunk;
+	class  Chunk_writer;
+
+	enum { MAX_CHUNKS = 64 };
+
+	using Chunk_ring = Spsc_ring<Chunk, MAX_CHUNKS>;
+}
+
+
+/*
+ * DMA buffer that is filled by one or multiple rx transfers
+ */
+struct Dma_recorder::Chunk
+{
+	Platform::Dma_buffer buffer;
+	size_t               used { 0 };
+
+	Chunk(Platform::Connection &platform, size_t size, Cache cache)
+	: buffer(platform, size, cache) { }
+
+	size_t size() const { return buffer.size(); }
+	size_t left() const { return size() - used; }
+};
+
+
+/*
+ * Thread that writes completed chunks to a file
+ *
+ * The capture path (producer) publishes completed chunks to the ring and
+ * wakes up the writer, which consumes the chunks and writes each of them
+ * with a single 'write()' call. After every chunk, the writer submits a
+ * progress signal so that a capture stalled on a full ring can resume.
+ */
+class Dma_recorder::Chunk_writer : Noncopyable
+{
+	public:
+
+		struct Stats
+		{
+			uint64_t      written { 0 };
+			unsigned long chunks  { 0 };
+			bool          error   { false };
+		};
+
+	private:
+
+		Chunk_ring                      &_ring;
+		int                        const _fd;
+		Signal_context_capability  const _progress_sigh;
+
+		Semaphore      _wakeup  { };
+		Mutex          _mutex   { };
+		Stats          _stats   { };
+		bool volatile  _stop    { false };
+		bool volatile  _done    { false };
+		pthread_t      _thread  { };
+
+		static void *_entry(void *arg)
+		{
+			static_cast<Chunk_writer *>(arg)->_run();
+			return nullptr;
+		}
+
+		bool _write(char const *src, size_t len)
+		{
+			while (len) {
+				ssize_t const n = ::write(_fd, src, len);
+				if (n < 0 && errno == EINTR)
+					continue;
+
+				if (n <= 0)
+					return false;
+
+				src += n;
+				len -= n;
+			}
+			return true;
+		}
+
+		void _run()
+		{
+			for (;;) {
+				_wakeup.down();
+
+				if (_ring.empty()) {
+					if (_stop) break;
+					continue;
+				}
+
+				bool   ok    = true;
+				size_t bytes = 0;
+				_ring.consume(1, [&] (Chunk &chunk) {
+					ok         = _write(chunk.buffer.local_addr<char>(), chunk.used);
+					bytes      = chunk.used;
+					chunk.used = 0;
+				});
+
+				{
+					Mutex::Guard guard(_mutex);
+					if (ok) {
+						_stats.written += bytes;
+						_stats.chunks++;
+					} else
+						_stats.error = true;
+				}
+
+				Signal_transmitter(_progress_sigh).submit();
+
+				if (!ok) break;
+			}
+
+			::fsync(_fd);
+
+			_done = true;
+			Signal_transmitter(_progress_sigh).submit();
+		}
+
+	public:
+
+		struct Start_failed : Exception { };
+
+		Chunk_writer(Chunk_ring &ring, int fd, Signal_context_capability progress_sigh)
+		: _ring(ring), _fd(fd), _progress_sigh(progress_sigh)
+		{ }
+
+		/**
+		 * Start writer thread, must be called from libc context
+		 *
+		 * \throw Start_failed
+		 */
+		void start()
+		{
+			if (pthread_create(&_thread, nullptr, _entry, this))
+				throw Start_failed();
+		}
+
+		/* notify writer about a published chunk */
+		void wakeup() { _wakeup.up(); }
+
+		/* let writer exit as soon as all published chunks are written */
+		void stop()
+		{
+			_stop = true;
+			_wakeup.up();
+		}
+
+		bool done() const { return _done; }
+
+		Stats stats()
+		{
+			Mutex::Guard guard(_mutex);
+			return _stats;
+		}
+};
+
+#endif /* _CHUNK_WRITER_H_ */
@@ -0,0 +1,418 @@
+/*
+ * \brief  Recorder for AXI DMA streams
+ * \author agent
+ * \date   2026-10-18
+ *
+ * The component captures the S2MM stream of an AXI DMA core into a ring of
+ * DMA chunks. Completed chunks are written to a file by a separate writer
+ * thread so that the capture path does not stall whenever the storage
+ * pauses. If the storage lags behind and the ring runs full, the capture
+ * either stalls (back-pressure) or continues into a scratch buffer and
+ * accounts the discarded data as dropped.
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <libc/component.h>
+#include <timer_session/connection.h>
+#include <base/attached_rom_dataspace.h>
+#include <os/reporter.h>
+
+/* Xilinx port includes */
+#include <xilinx_axidma.h>
+
+/* libc includes */
+#include <fcntl.h>
+
+/* local includes */
+#include <chunk_writer.h>
+
+namespace Dma_recorder { struct Main; }
+
+
+struct Dma_recorder::Main
+{
+	using Axidma = Xilinx::Axidma;
+	using Path   = String<256>;
+
+	/* behaviour if the ring of chunks is full */
+	enum Policy { BLOCK, DROP };
+
+	enum State { RECORDING, STALLED, STOPPING, STOPPED, FAILED };
+
+	Env &env;
+
+	Attached_rom_dataspace  config   { env, "config" };
+
+	Platform::Connection    platform { env };
+
+	Axidma axidma { env, platform, Axidma::Mode::NORMAL, device_from_xml() };
+
+	Axidma::Transfer_complete_handler<Main> rx_handler {
+		*this, &Main::handle_rx_complete };
+
+	Axidma::Transfer_error_handler<Main> error_handler {
+		*this, &Main::handle_error };
+
+	Path     const path          { config.xml().attribute_value("file", Path("/capture.raw")) };
+	bool     const append        { config.xml().attribute_value("append", false) };
+	Policy   const policy        { policy_from_xml() };
+	Cache    const cache         { config.xml().attribute_value("cached", false) ? CACHED : UNCACHED };
+	bool     const loopback      { config.xml().attribute_value("loopback", false) };
+	unsigned const num_chunks    { num_chunks_from_xml() };
+	size_t   const chunk_size    { align_addr((size_t)config.xml().attribute_value("chunk_size",
+	                                          Number_of_bytes { 1024*1024 }), 12) };
+	size_t   const transfer_size { transfer_size_from_xml() };
+	uint64_t const limit         { config.xml().attribute_value("max_bytes",
+	                                          Number_of_bytes { 0 }) };
+
+	Timer::Connection  timer    { env };
+	Expanding_reporter reporter { env, "recorder", "recorder" };
+
+	Timer::Periodic_timeout<Main> report_timeout {
+		timer, *this, &Main::handle_report_timeout,
+		Microseconds { 1000UL * config.xml().attribute_value("report_interval_ms", 1000U) } };
+
+	Signal_handler<Main> progress_handler { env.ep(), *this, &Main::handle_progress };
+
+	Chunk_ring           ring    { num_chunks, platform, chunk_size, cache };
+	Platform::Dma_buffer scratch { platform, transfer_size, cache };
+
+	/* tx source in loopback mode */
+	Constructible<Platform::Dma_buffer> pattern { };
+
+	int          fd     { open_file() };
+	Chunk_writer writer { ring, fd, progress_handler };
+
+	/* capture state */
+	State    state          { RECORDING };
+	bool     to_scratch     { false };
+	size_t   requested      { 0 };
+
+	/* statistics */
+	uint64_t      captured          { 0 };
+	uint64_t      dropped           { 0 };
+	unsigned long dropped_transfers { 0 };
+	unsigned long stalls            { 0 };
+	uint64_t      stalled_us        { 0 };
+	uint64_t      stall_start_us    { 0 };
+	unsigned      max_fill          { 0 };
+	uint64_t      start_us          { 0 };
+	uint64_t      stop_us           { 0 };
+	uint64_t      last_us           { 0 };
+	uint64_t      last_written      { 0 };
+	uint64_t      current_kb_per_s  { 0 };
+
+	Platform::Device::Name device_from_xml()
+	{
+		using Name = Platform::Device::Name;
+
+		Name const name = config.xml().attribute_value("device", Name());
+		return name != "" ? name : Axidma::device_name(platform, 0);
+	}
+
+	Policy policy_from_xml()
+	{
+		using Name = String<8>;
+
+		return config.xml().attribute_value("policy", Name("block")) == "drop"
+		       ? DROP : BLOCK;
+	}
+
+	unsigned num_chunks_from_xml()
+	{
+		unsigned const chunks = config.xml().attribute_value("chunks", 8U);
+
+		if (chunks < 2 || chunks > MAX_CHUNKS || (chunks & (chunks - 1))) {
+			error("number of chunks must be a power of two in [2..", (unsigned)MAX_CHUNKS, "]");
+			throw Exception();
+		}
+
+		return chunks;
+	}
+
+	size_t transfer_size_from_xml()
+	{
+		size_t const size = config.xml().attribute_value("transfer_size",
+		                                                 Number_of_bytes { chunk_size });
+
+		/* a chunk must consist of an integer number of transfers */
+		size_t result = min(chunk_size, axidma.max_transfer_size() & ~0xfffUL);
+		while (result > 0x1000 && (result > size || chunk_size % result))
+			result /= 2;
+
+		return max(result, (size_t)0x1000);
+	}
+
+	int open_file()
+	{
+		int result = -1;
+		Libc::with_libc([&] () {
+			result = ::open(path.string(),
+			                O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC), 0644);
+		});
+
+		if (result < 0) {
+			error("unable to open '", path, "'");
+			throw Exception();
+		}
+
+		return result;
+	}
+
+	static char const *state_name(State state)
+	{
+		switch (state) {
+		case RECORDING: return "recording";
+		case STALLED:   return "stalled";
+		case STOPPING:  return "stopping";
+		case STOPPED:   return "stopped";
+		case FAILED:    return "failed";
+		}
+		return "";
+	}
+
+	static uint64_t kb_per_s(uint64_t bytes, uint64_t us) {
+		return us ? (bytes * 1000) / (us * 1024) : 0; }
+
+	void submit(Platform::Dma_buffer const &, size_t offset, size_t len);
+	void start_transfer();
+	void publish_chunk();
+	void stop();
+	void fail(char const *);
+	void report();
+
+	void handle_rx_complete();
+	void handle_error(Axidma::Transfer_error const &);
+	void handle_progress();
+	void handle_report_timeout(Duration) { report(); }
+
+	Main(Env &env) : env(env)
+	{
+		if (loopback) {
+			pattern.construct(platform, transfer_size, cache);
+			uint32_t *words = pattern->local_addr<uint32_t>();
+			for (size_t i = 0; i < transfer_size / sizeof(uint32_t); i++)
+				words[i] = (uint32_t)i;
+
+			if (cache == CACHED)
+				Axidma::sync_for_device(*pattern, transfer_size);
+		}
+
+		axidma.rx_complete_handler(rx_handler);
+		axidma.error_handler(error_handler);
+		axidma.recovery_config(Axidma::Recovery_config { true, 3, 10000 });
+
+		Libc::with_libc([&] () { writer.start(); });
+
+		log("recording to '", path, "' (", num_chunks, " chunks of ",
+		    Number_of_bytes(chunk_size), ", transfers of ",
+		    Number_of_bytes(transfer_size), ")");
+
+		start_us = last_us = timer.elapsed_us();
+		start_transfer();
+	}
+};
+
+
+void Dma_recorder::Main::submit(Platform::Dma_buffer const &buf, size_t offset, size_t len)
+{
+	requested = len;
+
+	if (axidma.start_rx_transfer(buf, offset, len) != Axidma::Result::OKAY) {
+		fail("DMA rx transfer failed");
+		return;
+	}
+
+	if (loopback && axidma.start_tx_transfer(*pattern, len) != Axidma::Result::OKAY)
+		fail("DMA tx transfer failed");
+}
+
+
+void Dma_recorder::Main::start_transfer()
+{
+	if (state != RECORDING)
+		return;
+
+	if (limit && captured >= limit) {
+		stop();
+		return;
+	}
+
+	/*
+	 * The head slot stays owned by the capture path until it is published.
+	 * Chunks are only read by the writer, hence the cache holds no dirty
+	 * lines for them and invalidating after the transfer is sufficient.
+	 */
+	bool const started = ring.with_free_slot([&] (Chunk &chunk) {
+		to_scratch = false;
+		submit(chunk.buffer, chunk.used, min(transfer_size, chunk.left()));
+	});
+
+	if (started)
+		return;
+
+	/* the ring is full, i.e., the storage lags behind */
+	if (policy == BLOCK) {
+		state          = STALLED;
+		stall_start_us = timer.elapsed_us();
+		stalls++;
+		return;
+	}
+
+	to_scratch = true;
+	submit(scratch, 0, transfer_size);
+}
+
+
+void Dma_recorder::Main::publish_chunk()
+{
+	ring.produce(1, [] (Chunk &) { });
+	writer.wakeup();
+
+	max_fill = max(max_fill, ring.avail());
+}
+
+
+void Dma_recorder::Main::handle_rx_complete()
+{
+	if (state != RECORDING)
+		return;
+
+	size_t const len = min(axidma.rx_transferred(), requested);
+
+	if (to_scratch) {
+		dropped += len;
+		dropped_transfers++;
+		start_transfer();
+		return;
+	}
+
+	bool complete = false;
+	ring.with_free_slot([&] (Chunk &chunk) {
+		if (cache == CACHED)
+			Axidma::sync_for_cpu(chunk.buffer, chunk.used, len);
+
+		chunk.used += len;
+
+		/* publish chunk if full or if the stream signalled the end of a packet */
+		complete = !chunk.left() || len < requested;
+	});
+
+	captured += len;
+
+	if (complete)
+		publish_chunk();
+
+	start_transfer();
+}
+
+
+void Dma_recorder::Main::handle_error(Axidma::Transfer_error const &e)
+{
+	warning("DMA ", e.direction == Axidma::DMA_TO_DEVICE ? "tx" : "rx",
+	        " transfer failed (status ", Hex(e.status), ")",
+	        e.resubmitted ? ", resubmitted" : "");
+
+	if (!e.resubmitted)
+		fail("DMA failed - unable to recover");
+}
+
+
+void Dma_recorder::Main::handle_progress()
+{
+	if (writer.stats().error && state != FAILED) {
+		fail("writing to file failed");
+		return;
+	}
+
+	if (state == STALLED && !ring.full()) {
+		stalled_us += timer.elapsed_us() - stall_start_us;
+		state = RECORDING;
+		start_transfer();
+	}
+
+	if (state == STOPPING && writer.done()) {
+		Libc::with_libc([&] () { ::close(fd); });
+		state = STOPPED;
+
+		Chunk_writer::Stats const stats = writer.stats();
+		log("recording finished: ", stats.written, " bytes written, ",
+		    dropped, " bytes dropped, ",
+		    kb_per_s(stats.written, stop_us - start_us), " KB/s sustained");
+		report();
+	}
+}
+
+
+void Dma_recorder::Main::stop()
+{
+	/* hand the partially filled chunk to the writer */
+	bool partial = false;
+	ring.with_free_slot([&] (Chunk &chunk) { partial = chunk.used > 0; });
+	if (partial)
+		publish_chunk();
+
+	state   = STOPPING;
+	stop_us = timer.elapsed_us();
+	writer.stop();
+}
+
+
+void Dma_recorder::Main::fail(char const *msg)
+{
+	error(msg);
+
+	state   = FAILED;
+	stop_us = timer.elapsed_us();
+	writer.stop();
+	report();
+}
+
+
+void Dma_recorder::Main::report()
+{
+	Chunk_writer::Stats const stats = writer.stats();
+
+	uint64_t const now_us = (state == RECORDING || state == STALLED)
+	                      ? timer.elapsed_us() : stop_us;
+
+	if (now_us > last_us) {
+		current_kb_per_s = kb_per_s(stats.written - last_written, now_us - last_us);
+		last_written     = stats.written;
+		last_us          = now_us;
+	}
+
+	uint64_t const stalled = stalled_us + (state == STALLED
+	                                       ? now_us - stall_start_us : 0);
+
+	reporter.generate([&] (Xml_generator &xml) {
+		xml.attribute("file",              path);
+		xml.attribute("state",             state_name(state));
+		xml.attribute("policy",            policy == DROP ? "drop" : "block");
+		xml.attribute("captured",          captured);
+		xml.attribute("written",           stats.written);
+		xml.attribute("chunks_written",    stats.chunks);
+		xml.attribute("dropped",           dropped);
+		xml.attribute("dropped_transfers", dropped_transfers);
+		xml.attribute("stalls",            stalls);
+		xml.attribute("stalled_ms",        stalled / 1000);
+		xml.attribute("fill",              ring.avail());
+		xml.attribute("max_fill",          max_fill);
+		xml.attribute("chunks",            num_chunks);
+		xml.attribute("capture_kb_per_s",  kb_per_s(captured + dropped, now_us - start_us));
+		xml.attribute("write_kb_per_s",    kb_per_s(stats.written, now_us - start_us));
+		xml.attribute("current_kb_per_s",  current_kb_per_s);
+	});
+}
+
+
+void Libc::Component::construct(Libc::Env &env) {
+	static Dma_recorder::Main main(env);
+}
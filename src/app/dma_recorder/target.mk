@@ -0,0 +1,6 @@
+TARGET = dma_recorder
+
+REQUIRES := arm_v7a
+LIBS = base libc xilinx_axidma
+
+SRC_CC += main.cc
@@ -0,0 +1 @@
+/* required by xilinx_axidma */
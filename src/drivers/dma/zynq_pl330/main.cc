@@ -0,0 +1,196 @@
+/*
+ * \brief  Driver for the PL330 DMA controller of the Zynq PS
+ * \author agent
+ * \date   2026-10-18
+ *
+ * The driver provides a DMA service for memory copies and fills. Each
+ * session is bound to one DMA channel, hence up to eight clients are able
+ * to use the controller concurrently.
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/component.h>
+#include <base/heap.h>
+#include <root/component.h>
+#include <platform_session/connection.h>
+#include <platform_session/device.h>
+
+/* local includes */
+#include <pl330.h>
+#include <session_component.h>
+
+namespace Pl330 {
+	class Root;
+	struct Main;
+}
+
+
+class Pl330::Root : public Root_component<Session_component>
+{
+	private:
+
+		Env                  &_env;
+		Platform::Connection &_platform;
+		Mmio                 &_mmio;
+		unsigned const        _num_channels;
+
+		Session_component    *_channels[Mmio::MAX_CHANNELS] { };
+
+	protected:
+
+		Session_component *_create_session(char const *args) override
+		{
+			for (unsigned ch = 0; ch < _num_channels; ch++) {
+				if (_channels[ch])
+					continue;
+
+				_channels[ch] = new (md_alloc())
+					Session_component(_env,
+					                  session_resources_from_args(args),
+					                  session_label_from_args(args),
+					                  session_diag_from_args(args),
+					                  _platform, _mmio, ch);
+				return _channels[ch];
+			}
+
+			error("no free DMA channel for '", label_from_args(args), "'");
+			throw Service_denied();
+		}
+
+		void _upgrade_session(Session_component *session, const char *args) override
+		{
+			session->upgrade(ram_quota_from_args(args));
+			session->upgrade(cap_quota_from_args(args));
+		}
+
+		void _destroy_session(Session_component *session) override
+		{
+			_channels[session->channel()] = nullptr;
+			Genode::destroy(md_alloc(), session);
+		}
+
+	public:
+
+		Root(Env &env, Allocator &md_alloc, Platform::Connection &platform,
+		     Mmio &mmio, unsigned num_channels)
+		:
+			Root_component<Session_component>(env.ep(), md_alloc),
+			_env(env), _platform(platform), _mmio(mmio),
+			_num_channels(min(num_channels, (unsigned)Mmio::MAX_CHANNELS))
+		{ }
+
+		template <typename FN>
+		void with_channel(unsigned ch, FN const &fn)
+		{
+			if (ch < _num_channels && _channels[ch])
+				fn(*_channels[ch]);
+		}
+};
+
+
+struct Pl330::Main
+{
+	/*
+	 * Interrupt of a single channel, the device lists the abort interrupt
+	 * first followed by the channel interrupts
+	 */
+	struct Channel_irq
+	{
+		Main                 &_main;
+		unsigned const        _channel;
+		Platform::Device::Irq _irq;
+
+		Signal_handler<Channel_irq> _handler {
+			_main._env.ep(), *this, &Channel_irq::_handle };
+
+		void _handle()
+		{
+			_irq.ack();
+			_main._handle_channel_irq(_channel);
+		}
+
+		Channel_irq(Main &main, unsigned channel)
+		:
+			_main(main), _channel(channel),
+			_irq(main._device, Platform::Device::Irq::Index { channel + 1 })
+		{
+			_irq.sigh(_handler);
+		}
+	};
+
+	Env &_env;
+
+	Heap                 _heap     { _env.ram(), _env.rm() };
+	Platform::Connection _platform { _env };
+	Platform::Device     _device   { _platform };
+	Mmio                 _mmio     { _device };
+
+	unsigned const _num_channels { min(_mmio.channels(), (unsigned)Mmio::MAX_CHANNELS) };
+
+	Platform::Device::Irq _abort_irq { _device, Platform::Device::Irq::Index { 0 } };
+
+	Signal_handler<Main> _abort_handler { _env.ep(), *this, &Main::_handle_abort_irq };
+
+	Constructible<Channel_irq> _channel_irqs[Mmio::MAX_CHANNELS] { };
+
+	Root _root { _env, _heap, _platform, _mmio, _num_channels };
+
+	void _handle_channel_irq(unsigned ch)
+	{
+		if (!(_mmio.read<Mmio::Intmis>() & (1U << ch)))
+			return;
+
+		_mmio.write<Mmio::Intclr>(1U << ch);
+		_root.with_channel(ch, [&] (Session_component &session) {
+			session.handle_done(true); });
+	}
+
+	void _handle_abort_irq()
+	{
+		_abort_irq.ack();
+
+		if (_mmio.read<Mmio::Fsrd>())
+			error("DMA manager thread fault");
+
+		uint32_t const faulting = _mmio.read<Mmio::Fsrc>();
+		for (unsigned ch = 0; ch < _num_channels; ch++) {
+			if (!(faulting & (1U << ch)))
+				continue;
+
+			error("DMA channel ", ch, " fault (type ",
+			      Hex(_mmio.read<Mmio::Ftr>(ch)), ")");
+
+			_mmio.kill(ch);
+			_root.with_channel(ch, [&] (Session_component &session) {
+				session.handle_done(false); });
+		}
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		_abort_irq.sigh(_abort_handler);
+
+		for (unsigned ch = 0; ch < _num_channels; ch++)
+			_channel_irqs[ch].construct(*this, ch);
+
+		/* channel events raise interrupts */
+		_mmio.write<Mmio::Inten>((1U << _num_channels) - 1);
+
+		log("PL330 DMA controller with ", _num_channels, " channels");
+
+		_env.parent().announce(_env.ep().manage(_root));
+	}
+};
+
+
+void Component::construct(Genode::Env &env)
+{
+	static Pl330::Main main(env);
+}
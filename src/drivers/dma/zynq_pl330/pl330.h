@@ -0,0 +1,234 @@
+/*
+ * \brief  Registers and microcode of the ARM PL330 DMA controller
+ * \author agent
+ * \date   2026-10-18
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _SRC__DRIVERS__DMA__ZYNQ_PL330__PL330_H_
+#define _SRC__DRIVERS__DMA__ZYNQ_PL330__PL330_H_
+
+#include <platform_session/device.h>
+
+namespace Pl330 {
+	using namespace Genode;
+
+	struct Mmio;
+	class  Program;
+}
+
+
+struct Pl330::Mmio : Platform::Device::Mmio
+{
+	enum { MAX_CHANNELS = 8 };
+
+	struct Inten     : Register<0x020, 32> { };
+	struct Intmis    : Register<0x028, 32> { };
+	struct Intclr    : Register<0x02c, 32> { };
+
+	/* fault status of the manager thread and bitmap of faulting channels */
+	struct Fsrd      : Register<0x030, 32> { };
+	struct Fsrc      : Register<0x034, 32> { };
+
+	/* fault type per channel */
+	struct Ftr       : Register_array<0x040, 32, MAX_CHANNELS, 32> { };
+
+	/* channel status and program counter registers are interleaved */
+	struct Csr       : Register_array<0x100, 32, 2*MAX_CHANNELS, 32>
+	{
+		struct Status : Bitfield<0,4>
+		{
+			enum { STOPPED = 0x0, FAULTING = 0xf };
+		};
+	};
+
+	struct Dbgstatus : Register<0xd00, 32>
+	{
+		struct Busy : Bitfield<0,1> { };
+	};
+
+	struct Dbgcmd    : Register<0xd04, 32> { };
+
+	struct Dbginst0  : Register<0xd08, 32>
+	{
+		struct Channel_thread : Bitfield< 0,1> { };
+		struct Channel        : Bitfield< 8,3> { };
+		struct Byte0          : Bitfield<16,8> { };
+		struct Byte1          : Bitfield<24,8> { };
+	};
+
+	struct Dbginst1  : Register<0xd0c, 32> { };
+
+	struct Cr0       : Register<0xe00, 32>
+	{
+		struct Num_channels : Bitfield<4,3> { };
+	};
+
+	/* execute a single instruction via the debug interface */
+	void _debug_execute(Dbginst0::access_t inst0, Dbginst1::access_t inst1)
+	{
+		while (read<Dbgstatus::Busy>()) ;
+
+		write<Dbginst0>(inst0);
+		write<Dbginst1>(inst1);
+		write<Dbgcmd>(0);
+	}
+
+	unsigned channels() { return read<Cr0::Num_channels>() + 1; }
+
+	unsigned channel_status(unsigned ch) { return read<Csr::Status>(2*ch); }
+
+	/* start channel thread at the given program (DMAGO, secure) */
+	void go(unsigned ch, addr_t program)
+	{
+		Dbginst0::access_t inst0 = 0;
+		Dbginst0::Byte0::set(inst0, 0xa0);
+		Dbginst0::Byte1::set(inst0, ch);
+		_debug_execute(inst0, (Dbginst1::access_t)program);
+	}
+
+	/* terminate channel thread (DMAKILL) */
+	void kill(unsigned ch)
+	{
+		Dbginst0::access_t inst0 = 0;
+		Dbginst0::Byte0::set(inst0, 0x01);
+		Dbginst0::Channel::set(inst0, ch);
+		Dbginst0::Channel_thread::set(inst0, 1);
+		_debug_execute(inst0, 0);
+	}
+
+	Mmio(Platform::Device &device) : Platform::Device::Mmio(device) { }
+};
+
+
+/*
+ * Assembler for channel programs
+ */
+class Pl330::Program
+{
+	public:
+
+		enum Reg { SAR = 0, CCR = 1, DAR = 2 };
+
+		/* burst length of the bulk part of a transfer */
+		enum { BURST_LEN = 16 };
+
+	private:
+
+		uint8_t * const _base;
+		size_t    const _size;
+		size_t          _pos      { 0 };
+		bool            _overflow { false };
+
+		void _byte(uint8_t value)
+		{
+			if (_pos >= _size) {
+				_overflow = true;
+				return;
+			}
+			_base[_pos++] = value;
+		}
+
+		void _word(uint32_t value)
+		{
+			for (unsigned i = 0; i < 4; i++)
+				_byte((uint8_t)(value >> (8*i)));
+		}
+
+		/*
+		 * Channel control value
+		 *
+		 * Bursts consist of 'len' beats of 2^size_log2 bytes. The
+		 * protection and cache control bits remain 0, i.e., secure,
+		 * non-cacheable and non-bufferable accesses.
+		 */
+		static uint32_t _ccr(unsigned size_log2, unsigned len, bool src_inc)
+		{
+			return (src_inc ? 1U : 0U)
+			     | (size_log2 << 1) | ((len - 1) << 4)
+			     | (1U << 14)
+			     | (size_log2 << 15) | ((len - 1) << 18);
+		}
+
+	public:
+
+		Program(void *base, size_t size)
+		: _base((uint8_t *)base), _size(size) { }
+
+		size_t size()     const { return _pos; }
+		bool   overflow() const { return _overflow; }
+
+		void mov(Reg reg, uint32_t value) { _byte(0xbc); _byte((uint8_t)reg); _word(value); }
+		void ld()                         { _byte(0x04); }
+		void st()                         { _byte(0x08); }
+		void wmb()                        { _byte(0x13); }
+		void sev(unsigned event)          { _byte(0x34); _byte((uint8_t)(event << 3)); }
+		void end()                        { _byte(0x00); }
+
+		/*
+		 * Execute 'body' 'n' times (1..256) using loop counter 'lc'
+		 */
+		template <typename FN>
+		void loop(unsigned lc, unsigned n, FN const &body)
+		{
+			if (n == 0) return;
+			if (n == 1) { body(); return; }
+
+			_byte((uint8_t)(0x20 | (lc << 1)));
+			_byte((uint8_t)(n - 1));
+
+			size_t const start = _pos;
+			body();
+
+			size_t const jump = _pos - start;
+			_byte((uint8_t)(0x38 | (lc << 2)));
+			_byte((uint8_t)jump);
+		}
+
+		/*
+		 * Transfer 'len' bytes from 'src' to 'dst'
+		 *
+		 * If 'src_inc' is false, all beats read from 'src', which is used
+		 * for filling memory from a pattern of 8 equal bytes.
+		 */
+		void transfer(addr_t dst, addr_t src, size_t len, bool src_inc)
+		{
+			/* largest beat size (up to 64 bit) that matches the alignment */
+			addr_t const align = dst | (src_inc ? src : 0) | 8;
+			unsigned size_log2 = 0;
+			while (!(align & (1UL << size_log2)))
+				size_log2++;
+
+			size_t const unit   = (1UL << size_log2) * BURST_LEN;
+			size_t       bursts = len / unit;
+			size_t const tail   = len % unit;
+
+			mov(SAR, (uint32_t)src);
+			mov(DAR, (uint32_t)dst);
+			mov(CCR, _ccr(size_log2, BURST_LEN, src_inc));
+
+			auto burst = [&] () { ld(); st(); };
+
+			/* nested loops transfer up to 256*256 bursts */
+			while (bursts >= 256) {
+				unsigned const outer = (unsigned)min(bursts / 256, (size_t)256);
+				loop(0, outer, [&] () { loop(1, 256, burst); });
+				bursts -= outer * 256;
+			}
+			loop(0, (unsigned)bursts, burst);
+
+			/* remainder as single-byte beats */
+			if (tail) {
+				mov(CCR, _ccr(0, 1, src_inc));
+				loop(0, (unsigned)tail, burst);
+			}
+		}
+};
+
+#endif /* _SRC__DRIVERS__DMA__ZYNQ_PL330__PL330_H_ */
@@ -0,0 +1,328 @@
+/*
+ * \brief  DMA session component bound to a PL330 channel
+ * \author agent
+ * \date   2026-10-18
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _SRC__DRIVERS__DMA__ZYNQ_PL330__SESSION_COMPONENT_H_
+#define _SRC__DRIVERS__DMA__ZYNQ_PL330__SESSION_COMPONENT_H_
+
+#include <base/session_object.h>
+#include <platform_session/connection.h>
+#include <platform_session/dma_buffer.h>
+#include <dma_session/dma_session.h>
+#include <util/spsc_ring.h>
+
+/* local includes */
+#include <pl330.h>
+
+namespace Pl330 { class Session_component; }
+
+
+class Pl330::Session_component : public Session_object<Dma::Session>
+{
+	public:
+
+		enum { QUEUE_SIZE = 16, PROGRAM_SIZE = 4096 };
+
+	private:
+
+		using Buffer_id = Dma::Session::Buffer_id;
+		using Chain     = Dma::Session::Chain;
+		using Job       = Dma::Session::Job;
+
+		struct Buffer
+		{
+			Ram_dataspace_capability cap;
+			addr_t                   dma_addr;
+			size_t                   size;
+			bool                     freed { false };  /* release when idle */
+		};
+
+		struct Entry
+		{
+			Chain  chain  { };
+			Ticket ticket { 0 };
+			bool   failed { false };  /* refers to a freed buffer */
+		};
+
+		Platform::Connection &_platform;
+		Mmio                 &_mmio;
+		unsigned const        _channel;
+
+		Constructible<Buffer> _buffers[MAX_BUFFERS] { };
+
+		/* program memory, fill patterns are placed at the end */
+		Platform::Dma_buffer  _program { _platform, PROGRAM_SIZE, UNCACHED };
+
+		Entry           _queue[QUEUE_SIZE] { };
+		Spsc_ring_index _queue_index { QUEUE_SIZE };
+
+		bool            _busy   { false };
+		Ticket          _ticket { 0 };
+		Status          _status { 0, 0, 0 };
+
+		Signal_context_capability _sigh { };
+
+		bool _valid(Buffer_id id, size_t offset, size_t len) const
+		{
+			return id.value < MAX_BUFFERS && _buffers[id.value].constructed() &&
+			       !_buffers[id.value]->freed &&
+			       len && offset + len <= _buffers[id.value]->size;
+		}
+
+		bool _valid(Job const &job) const
+		{
+			if (!_valid(job.dst, job.dst_offset, job.len))
+				return false;
+
+			return job.op == Job::FILL || _valid(job.src, job.src_offset, job.len);
+		}
+
+		static bool _uses(Chain const &chain, Buffer_id id)
+		{
+			for (unsigned i = 0; i < chain.count; i++) {
+				Job const &job = chain.jobs[i];
+				if (job.dst.value == id.value ||
+				    (job.op == Job::COPY && job.src.value == id.value))
+					return true;
+			}
+			return false;
+		}
+
+		addr_t _dma_addr(Buffer_id id, size_t offset) const {
+			return _buffers[id.value]->dma_addr + offset; }
+
+		/*
+		 * Compile chain into a single channel program
+		 *
+		 * \return  false if the program does not fit into program memory
+		 */
+		bool _compile(Chain const &chain)
+		{
+			enum { PATTERN_SIZE = 8 };
+
+			size_t const patterns = MAX_CHAIN * PATTERN_SIZE;
+
+			uint8_t * const base    = _program.local_addr<uint8_t>();
+			uint8_t * const pattern = base + PROGRAM_SIZE - patterns;
+			addr_t    const pattern_dma = _program.dma_addr() + PROGRAM_SIZE - patterns;
+
+			Program program { base, PROGRAM_SIZE - patterns };
+
+			for (unsigned i = 0; i < chain.count; i++) {
+				Job const &job = chain.jobs[i];
+
+				addr_t const dst = _dma_addr(job.dst, job.dst_offset);
+
+				if (job.op == Job::FILL) {
+					Genode::memset(pattern + i*PATTERN_SIZE, job.value, PATTERN_SIZE);
+					program.transfer(dst, pattern_dma + i*PATTERN_SIZE, job.len, false);
+				} else
+					program.transfer(dst, _dma_addr(job.src, job.src_offset), job.len, true);
+			}
+
+			/* wait for outstanding writes before signalling completion */
+			program.wmb();
+			program.sev(_channel);
+			program.end();
+
+			return !program.overflow();
+		}
+
+		void _complete(bool success)
+		{
+			Entry const &entry = _queue[_queue_index.tail_slot()];
+
+			_status.completed = entry.ticket;
+			if (!success) {
+				_status.last_error = entry.ticket;
+				_status.errors++;
+			}
+
+			_queue_index.consume();
+			_busy = false;
+
+			if (_sigh.valid())
+				Signal_transmitter(_sigh).submit();
+		}
+
+		/*
+		 * Release freed buffers, must only be called while the channel is idle
+		 */
+		void _release_freed()
+		{
+			for (unsigned i = 0; i < MAX_BUFFERS; i++) {
+				if (!_buffers[i].constructed() || !_buffers[i]->freed)
+					continue;
+
+				_platform.free_dma_buffer(_buffers[i]->cap);
+				_ram_quota_guard().replenish(Ram_quota { _buffers[i]->size });
+				_buffers[i].destruct();
+			}
+		}
+
+		void _kick()
+		{
+			while (!_busy && !_queue_index.empty()) {
+				Entry const &entry = _queue[_queue_index.tail_slot()];
+
+				if (entry.failed) {
+					_complete(false);
+					continue;
+				}
+
+				if (!_compile(entry.chain)) {
+					warning("channel ", _channel, ": chain exceeds program memory");
+					_complete(false);
+					continue;
+				}
+
+				_busy = true;
+				_mmio.go(_channel, _program.dma_addr());
+			}
+		}
+
+	public:
+
+		Session_component(Env                   &env,
+		                  Resources       const &resources,
+		                  Label           const &label,
+		                  Diag            const &diag,
+		                  Platform::Connection  &platform,
+		                  Mmio                  &mmio,
+		                  unsigned               channel)
+		:
+			Session_object(env.ep(), resources, label, diag),
+			_platform(platform), _mmio(mmio), _channel(channel)
+		{ }
+
+		~Session_component()
+		{
+			if (_busy)
+				_mmio.kill(_channel);
+
+			for (unsigned i = 0; i < MAX_BUFFERS; i++)
+				if (_buffers[i].constructed())
+					_buffers[i]->freed = true;
+
+			_release_freed();
+		}
+
+		unsigned channel() const { return _channel; }
+
+		/*
+		 * Called by the driver on the channel event or a channel fault
+		 */
+		void handle_done(bool success)
+		{
+			if (!_busy)
+				return;
+
+			_complete(success);
+			_release_freed();
+			_kick();
+		}
+
+
+		/****************************
+		 ** Dma::Session interface **
+		 ****************************/
+
+		Buffer_id alloc_buffer(size_t size) override
+		{
+			for (unsigned i = 0; i < MAX_BUFFERS; i++) {
+				if (_buffers[i].constructed())
+					continue;
+
+				size = align_addr(size, 12);
+
+				/* account buffer to the session quota */
+				_ram_quota_guard().withdraw(Ram_quota { size });
+
+				Ram_dataspace_capability cap { };
+				try {
+					cap = _platform.alloc_dma_buffer(size, UNCACHED);
+				} catch (...) {
+					_ram_quota_guard().replenish(Ram_quota { size });
+					throw;
+				}
+
+				_buffers[i].construct(Buffer { cap, _platform.dma_addr(cap), size });
+				return Buffer_id { i };
+			}
+
+			throw Out_of_buffers();
+		}
+
+		Dataspace_capability dataspace(Buffer_id id) override
+		{
+			if (id.value >= MAX_BUFFERS || !_buffers[id.value].constructed() ||
+			    _buffers[id.value]->freed)
+				return Dataspace_capability();
+
+			return _buffers[id.value]->cap;
+		}
+
+		void free_buffer(Buffer_id id) override
+		{
+			if (id.value >= MAX_BUFFERS || !_buffers[id.value].constructed() ||
+			    _buffers[id.value]->freed)
+				return;
+
+			_buffers[id.value]->freed = true;
+
+			/* queued chains referring to the buffer fail once they are due */
+			for (unsigned i = _busy ? 1 : 0; i < _queue_index.avail(); i++) {
+				Entry &entry = _queue[_queue_index.tail_slot(i)];
+				if (_uses(entry.chain, id))
+					entry.failed = true;
+			}
+
+			/* the buffer is released once the running chain completed */
+			if (_busy && !_uses(_queue[_queue_index.tail_slot()].chain, id))
+				return;
+
+			/* buffers must not vanish while the channel accesses them */
+			if (_busy) {
+				_mmio.kill(_channel);
+				_complete(false);
+			}
+
+			_release_freed();
+			_kick();
+		}
+
+		void completion_sigh(Signal_context_capability sigh) override {
+			_sigh = sigh; }
+
+		Ticket submit(Chain const &chain) override
+		{
+			if (!chain.count || chain.count > MAX_CHAIN || _queue_index.full())
+				return 0;
+
+			for (unsigned i = 0; i < chain.count; i++)
+				if (!_valid(chain.jobs[i]))
+					return 0;
+
+			Entry &entry = _queue[_queue_index.head_slot()];
+			entry.chain  = chain;
+			entry.ticket = ++_ticket;
+			_queue_index.produce();
+
+			_kick();
+
+			return _ticket;
+		}
+
+		Status status() override { return _status; }
+};
+
+#endif /* _SRC__DRIVERS__DMA__ZYNQ_PL330__SESSION_COMPONENT_H_ */
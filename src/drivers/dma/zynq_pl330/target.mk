@@ -0,0 +1,5 @@
+TARGET   = zynq_pl330_drv
+REQUIRES = arm_v7
+SRC_CC   = main.cc
+LIBS     = base
+INC_DIR += $(PRG_DIR)
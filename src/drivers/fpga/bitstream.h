@@ -10,6 +10,9 @@
  *
  * For ease of use, we detect whether there is header information and
  * perform the byte swapping.
+ *
+ * Either file may be compressed in the LZ4 frame format. A compressed
+ * bitstream is decompressed on the fly while it is read sequentially.
  */
 
 /*
@@ -24,6 +27,12 @@
 
 #include <base/attached_rom_dataspace.h>
 #include <util/endian.h>
+#include <util/reconstructible.h>
+
+/* local includes */
+#include "swap.h"
+#include "lz4.h"
+#include "digest.h"
 
 namespace Fpga {
 	using namespace Genode;
@@ -44,40 +53,162 @@ class Fpga::Bitstream
 		              RAW         = 1,
 		              SWAP_NEEDED = 2 };
 
-		size_t                  _bitstream_size { 0 };
-		Format                  _format { INVALID };
-		size_t                  _offset { 0 };
-		Attached_rom_dataspace &_rom;
+		/*
+		 * The start of a compressed bitstream is decompressed in advance for
+		 * detecting the format. Swapping is performed via a staging buffer
+		 * because the destination is typically uncached DMA memory.
+		 */
+		enum { HEAD_SIZE = 4096, STAGE_SIZE = 16*1024 };
+
+		size_t       _bitstream_size { 0 };
+		Format       _format { INVALID };
+		size_t       _offset { 0 };
+		char const * _data;
+
+		Constructible<Lz4_stream> _lz4 { };
 
-		static Format _detect_format(char * buf, size_t buf_sz, size_t & offset, size_t & length);
-		static size_t _parse_header_field(char magic, char * buf, size_t buf_sz, size_t pos);
-		static size_t _parse_size_field(char * buf, size_t buf_sz, size_t pos, size_t & size);
+		char   _head[HEAD_SIZE];
+		alignas(4) char _stage[STAGE_SIZE];
+		size_t _head_size { 0 };
+		size_t _position  { 0 };
 
-		size_t _read_swapped(char * dst, size_t size) const;
+		/* digest of the content read sequentially so far, before swapping */
+		Digest _digest   { };
+		size_t _digested { 0 };
+
+		void _digest_update(char const *src, size_t offset, size_t size)
+		{
+			if (offset != _digested)
+				return;
+
+			_digest.update(src, size);
+			_digested += size;
+		}
 
-		char *_bitstream_start() const { return _rom.local_addr<char>() + _offset; }
+		static Format _detect_format(char const * buf, size_t buf_sz, size_t & offset, size_t & length);
+		static size_t _parse_header_field(char magic, char const * buf, size_t buf_sz, size_t pos);
+		static size_t _parse_size_field(char const * buf, size_t buf_sz, size_t pos, size_t & size);
+
+		size_t _read_swapped(char * dst, size_t offset, size_t size);
+
+		char const *_bitstream_start() const { return _data + _offset; }
+
+		/* copy data and swap if needed */
+		void _convert(char *dst, char const *src, size_t size) const
+		{
+			if (_format == SWAP_NEEDED)
+				swap_words(reinterpret_cast<uint32_t*>(dst),
+				           reinterpret_cast<uint32_t const*>(src), size / 4);
+			else
+				Genode::memcpy(dst, src, size);
+		}
+
+		/*
+		 * Fill the stage with 'len' bytes of decompressed data starting at
+		 * bitstream offset 'pos', the head precedes the decoder output
+		 */
+		size_t _fill_stage(size_t pos, size_t len)
+		{
+			size_t const start  = _offset + pos;
+			size_t       filled = 0;
+
+			if (start < _head_size) {
+				filled = min(len, _head_size - start);
+				Genode::memcpy(_stage, _head + start, filled);
+			}
+
+			while (filled < len) {
+				size_t const n = _lz4->read(_stage + filled, len - filled);
+				if (!n)
+					break;
+				filled += n;
+			}
+
+			return filled;
+		}
+
+		size_t _read_compressed(char *dst, size_t offset, size_t size)
+		{
+			if (offset != _position) {
+				error("compressed bitstream must be read sequentially");
+				return 0;
+			}
+
+			/*
+			 * Whole words are staged at a time so that each stage starts
+			 * on the word grid of the bitstream, regardless of whether the
+			 * header length of a .bit file is a multiple of 4
+			 */
+			if (_format == SWAP_NEEDED)
+				size &= ~(size_t)0x3;
+
+			size_t done = 0;
+			while (done < size) {
+				size_t const n = _fill_stage(offset + done,
+				                             min(size - done, (size_t)STAGE_SIZE));
+				if (!n)
+					break;
+
+				_digest_update(_stage, offset + done, n);
+				_convert(dst + done, _stage, n);
+				done += n;
+			}
+
+			_position += done;
+
+			return (_format == SWAP_NEEDED) ? done & ~(size_t)0x3 : done;
+		}
 
 	public:
 
-		Bitstream(Attached_rom_dataspace &rom, size_t max_size = 0)
-		: _rom(rom)
+		/**
+		 * Constructor
+		 *
+		 * \param data       content of the bitstream file
+		 * \param data_size  size of the bitstream file
+		 * \param max_size   size of a RAW bitstream, 0 if unknown
+		 *
+		 * \throw Format_error
+		 */
+		Bitstream(char const *data, size_t data_size, size_t max_size = 0)
+		: _data(data)
 		{
 			size_t length { 0 };
 
+			char const *buf    = data;
+			size_t      buf_sz = data_size;
+			size_t      total  = data_size;
+
+			/* detect format of the decompressed start of the bitstream */
+			if (Lz4_stream::detect(buf, buf_sz)) {
+				try { _lz4.construct(buf, buf_sz); }
+				catch (Lz4_stream::Format_error) { throw Format_error(); }
+
+				_head_size = _lz4->read(_head, HEAD_SIZE);
+				buf        = _head;
+				buf_sz     = _head_size;
+				total      = _lz4->content_size();
+			}
+
 			/* detect format and store in members */
-			_format = _detect_format(_rom.local_addr<char>(), _rom.size(), _offset, length);
+			_format = _detect_format(buf, buf_sz, _offset, length);
 			switch (_format)
 			{
 				case INVALID:
 					error("Invalid bitstream file");
 					throw Format_error();
 				case RAW:
+					if (max_size == 0 && total == 0) {
+						error("size of compressed raw/bin bitstream is unknown");
+						throw Format_error();
+					}
+
 					if (max_size == 0) {
 						warning("no max_size attribute provided for bitstream in raw/bin format");
-						_bitstream_size = _rom.size();
+						_bitstream_size = total;
 					}
 					else
-						_bitstream_size = min(_rom.size(), max_size);
+						_bitstream_size = total ? min(total, max_size) : max_size;
 					break;
 				case SWAP_NEEDED:
 					_bitstream_size = length;
@@ -85,29 +216,64 @@ class Fpga::Bitstream
 			}
 		}
 
-		size_t read_bitstream(char *dst, size_t dst_sz) const
+		Bitstream(Attached_rom_dataspace &rom, size_t max_size = 0)
+		: Bitstream(rom.local_addr<char const>(), rom.size(), max_size) { }
+
+		/**
+		 * Copy up to 'dst_sz' bytes of the bitstream starting at 'offset'
+		 *
+		 * \return  number of bytes copied
+		 */
+		size_t read_bitstream(char *dst, size_t offset, size_t dst_sz)
 		{
-			size_t sz = min(_bitstream_size, dst_sz);
+			if (offset >= _bitstream_size)
+				return 0;
+
+			size_t sz = min(_bitstream_size - offset, dst_sz);
+
+			if (_lz4.constructed())
+				return _read_compressed(dst, offset, sz);
 
 			switch (_format)
 			{
 				case RAW:
-					Genode::memcpy(dst, _bitstream_start(), sz);
+					_digest_update(_bitstream_start() + offset, offset, sz);
+					Genode::memcpy(dst, _bitstream_start() + offset, sz);
 					return sz;
 				case SWAP_NEEDED:
-					return _read_swapped(dst, sz);
+					return _read_swapped(dst, offset, sz);
 				default:
 					return 0;
 			}
 		}
 
 		size_t size() const { return _bitstream_size; }
+
+		bool compressed() const { return _lz4.constructed(); }
+
+		/**
+		 * Return true if the bitstream is stored as is, i.e., neither
+		 * compressed nor in need of swapping
+		 */
+		bool raw() const { return _format == RAW && !_lz4.constructed(); }
+
+		/**
+		 * Digest of the bitstream content
+		 *
+		 * The digest is computed while the bitstream is read and is valid
+		 * once it has been read sequentially as a whole. The digest covers
+		 * the content as stored in the file, i.e., before swapping.
+		 */
+		Digest digest() const { return _digest; }
+
+		/* offset of the bitstream data within the ROM dataspace */
+		size_t offset() const { return _offset; }
 };
 
 
 Genode::size_t
 Fpga::Bitstream::_parse_header_field(char            magic,
-                                     char          * buf,
+                                     char const    * buf,
                                      Genode::size_t  buf_sz,
                                      Genode::size_t  pos)
 {
@@ -118,13 +284,13 @@ Fpga::Bitstream::_parse_header_field(char            magic,
 		throw Header_error();
 	}
 
-	uint16_t length = host_to_big_endian(*reinterpret_cast<uint16_t*>(&buf[pos+1]));
+	uint16_t length = host_to_big_endian(*reinterpret_cast<uint16_t const*>(&buf[pos+1]));
 	return length+3;
 }
 
 
 Genode::size_t
-Fpga::Bitstream::_parse_size_field(char           * buf,
+Fpga::Bitstream::_parse_size_field(char const     * buf,
                                    Genode::size_t   buf_sz,
                                    Genode::size_t   pos,
                                    Genode::size_t & size)
@@ -135,13 +301,13 @@ Fpga::Bitstream::_parse_size_field(char           * buf,
 	if (buf[pos] != 0x65)
 		throw Header_error();
 
-	size = host_to_big_endian(*reinterpret_cast<uint32_t*>(&buf[pos+1]));
+	size = host_to_big_endian(*reinterpret_cast<uint32_t const*>(&buf[pos+1]));
 	return 5;
 }
 
 
 Fpga::Bitstream::Format
-Fpga::Bitstream::_detect_format(char           * buf,
+Fpga::Bitstream::_detect_format(char const     * buf,
                                 Genode::size_t   buf_sz,
                                 Genode::size_t & offset,
                                 Genode::size_t & length)
@@ -151,7 +317,7 @@ Fpga::Bitstream::_detect_format(char           * buf,
 	enum { MAGIC_SWAPPED = 0x665599aa };
 	enum { MAGIC         = 0xaa995566 };
 
-	uint32_t first_word = *reinterpret_cast<uint32_t*>(buf);
+	uint32_t first_word = *reinterpret_cast<uint32_t const*>(buf);
 
 	if (first_word == HDR_START)
 	{
@@ -184,7 +350,7 @@ Fpga::Bitstream::_detect_format(char           * buf,
 
 	/* find MAGIC or MAGIC_SWAPPED */
 	for (size_t byte = offset; byte < buf_sz; byte++) {
-		uint32_t cur_word = *reinterpret_cast<uint32_t*>(&buf[byte]);
+		uint32_t cur_word = *reinterpret_cast<uint32_t const*>(&buf[byte]);
 		if (cur_word == MAGIC)
 			return RAW;
 		if (cur_word == MAGIC_SWAPPED)
@@ -195,20 +361,21 @@ Fpga::Bitstream::_detect_format(char           * buf,
 }
 
 
-Genode::size_t Fpga::Bitstream::_read_swapped(char * dst, size_t size) const
+Genode::size_t Fpga::Bitstream::_read_swapped(char * dst, size_t offset, size_t size)
 {
 	size_t written { 0 };
 
 	if (size & 0x3)
 		error("Skipping last incomplete word of bitstream");
 
-	uint32_t * dst_words = reinterpret_cast<uint32_t*>(dst);
-	uint32_t * src_words = reinterpret_cast<uint32_t*>(_bitstream_start());
-	for (size_t word { 0 }; word < size / 4; word++, written += 4)
-	{
-		/* copy word and swap endianess */
-		dst_words[word] = host_to_big_endian(src_words[word]);
-	}
+	uint32_t       * dst_words = reinterpret_cast<uint32_t*>(dst);
+	uint32_t const * src_words = reinterpret_cast<uint32_t const*>(_bitstream_start() + offset);
+
+	written = size & ~(size_t)0x3;
+	_digest_update(_bitstream_start() + offset, offset, written);
+
+	/* copy words and swap endianess */
+	swap_words(dst_words, src_words, size / 4);
 
 	return written;
 }
@@ -0,0 +1,293 @@
+/*
+ * \brief  Cache of pre-staged bitstreams
+ * \author agent
+ * \date   2026-10-18
+ *
+ * Candidate bitstreams are parsed, decompressed and byte-swapped in
+ * advance into resident DMA buffers. Loading a cached bitstream merely
+ * starts the PCAP DMA. The total size of the cached bitstreams is limited
+ * by a memory budget.
+ *
+ * The buffer of a cached bitstream may still be read by the PCAP when the
+ * bitstream is re-staged or dropped from the cache. Such a buffer is
+ * retired and released not before the loader signals the completion of
+ * the job.
+ */
+
+/*
+ * Copyright (C) 2023 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _DRIVERS__FPGA__BITSTREAM_CACHE_H_
+#define _DRIVERS__FPGA__BITSTREAM_CACHE_H_
+
+#include <base/registry.h>
+#include <base/allocator.h>
+#include <platform_session/dma_buffer.h>
+
+/* local includes */
+#include "bitstream.h"
+#include "pcap.h"
+#include "digest.h"
+
+namespace Fpga {
+	using namespace Genode;
+
+	class Bitstream_cache;
+}
+
+
+class Fpga::Bitstream_cache : Noncopyable
+{
+	public:
+
+		using Name = String<128>;
+
+	private:
+
+		struct Buffer
+		{
+			Platform::Dma_buffer dma;
+
+			/* element of the retired buffers */
+			Constructible<Registry<Buffer>::Element> retired { };
+
+			Buffer(Platform::Connection &platform, size_t size)
+			: dma(platform, size, UNCACHED) { }
+		};
+
+		struct Entry
+		{
+			Bitstream_cache &_cache;
+
+			Name   const name;
+			size_t const max_size;
+			bool         seen { true };
+
+			Attached_rom_dataspace rom;
+
+			Buffer *buffer { nullptr };
+			size_t  size   { 0 };
+			Digest  digest { };
+
+			Signal_handler<Entry> rom_handler;
+
+			Entry(Env &env, Bitstream_cache &cache, Name const &name, size_t max_size)
+			:
+				_cache(cache), name(name), max_size(max_size),
+				rom(env, name.string()),
+				rom_handler(env.ep(), *this, &Entry::stage)
+			{
+				stage();
+				rom.sigh(rom_handler);
+			}
+
+			bool staged() const { return buffer != nullptr; }
+
+			void stage()
+			{
+				rom.update();
+
+				_cache._release(*this);
+				_cache._stage(*this);
+			}
+		};
+
+		Env                  &_env;
+		Allocator            &_alloc;
+		Platform::Connection &_platform;
+		Pcap_loader          &_loader;
+
+		Registry<Registered<Entry>> _entries { };
+		Registry<Buffer>            _retired { };
+
+		size_t _budget { 0 };
+		size_t _used   { 0 };
+
+		/* bitstream used for staging, too large for the stack */
+		Constructible<Bitstream> _bitstream { };
+
+		Signal_handler<Bitstream_cache> _job_done_handler {
+			_env.ep(), *this, &Bitstream_cache::_handle_job_done };
+
+		/*
+		 * Drop the buffer of 'entry', retire it if the PCAP may read it
+		 *
+		 * The buffer no longer counts for the budget once retired.
+		 */
+		void _release(Entry &entry)
+		{
+			if (!entry.buffer)
+				return;
+
+			Buffer &buffer = *entry.buffer;
+
+			_used       -= buffer.dma.size();
+			entry.buffer = nullptr;
+			entry.size   = 0;
+
+			if (_loader.reads_from(buffer.dma.dma_addr()))
+				buffer.retired.construct(_retired, buffer);
+			else
+				destroy(_alloc, &buffer);
+		}
+
+		void _handle_job_done()
+		{
+			_retired.for_each([&] (Buffer &buffer) {
+				if (!_loader.reads_from(buffer.dma.dma_addr()))
+					destroy(_alloc, &buffer); });
+		}
+
+		void _stage(Entry &entry)
+		{
+			try {
+				_bitstream.construct(entry.rom, entry.max_size);
+			} catch (Bitstream::Format_error) {
+				warning("cannot stage invalid bitstream ", entry.name);
+				return;
+			}
+
+			size_t const size     = _bitstream->size();
+			size_t const required = align_addr(size, 12);
+
+			if (_used + required > _budget) {
+				warning("bitstream ", entry.name, " exceeds cache budget");
+				_bitstream.destruct();
+				return;
+			}
+
+			try {
+				entry.buffer = new (_alloc) Buffer(_platform, required);
+			} catch (...) {
+				warning("failed to allocate DMA buffer for bitstream ", entry.name);
+				_bitstream.destruct();
+				return;
+			}
+
+			entry.size   = _bitstream->read_bitstream(entry.buffer->dma.local_addr<char>(), 0, size);
+			entry.digest = _bitstream->digest();
+			_used       += required;
+			_bitstream.destruct();
+
+			log("staged bitstream ", entry.name, " (", Number_of_bytes(entry.size), ")");
+		}
+
+	public:
+
+		Bitstream_cache(Env &env, Allocator &alloc, Platform::Connection &platform,
+		                Pcap_loader &loader)
+		: _env(env), _alloc(alloc), _platform(platform), _loader(loader)
+		{
+			_loader.job_done_sigh(_job_done_handler);
+		}
+
+		~Bitstream_cache()
+		{
+			_loader.job_done_sigh(Signal_context_capability());
+
+			_entries.for_each([&] (Registered<Entry> &entry) {
+				_release(entry);
+				destroy(_alloc, &entry);
+			});
+
+			_retired.for_each([&] (Buffer &buffer) {
+				destroy(_alloc, &buffer); });
+		}
+
+		/**
+		 * Update set of cached bitstreams from '<cache>' node
+		 */
+		void update(Xml_node const &node)
+		{
+			size_t const budget = node.attribute_value("budget", Number_of_bytes { 0 });
+
+			/* release all buffers to re-stage the entries within the new budget */
+			bool const restage = (budget != _budget);
+			if (restage) {
+				_budget = budget;
+				_entries.for_each([&] (Entry &entry) { _release(entry); });
+			}
+
+			_entries.for_each([&] (Entry &entry) { entry.seen = false; });
+
+			node.for_each_sub_node("bitstream", [&] (Xml_node const &xml) {
+				Name   const name     = xml.attribute_value("name", Name());
+				size_t const max_size = xml.attribute_value("size", 0UL);
+				if (name == "")
+					return;
+
+				bool found = false;
+				_entries.for_each([&] (Entry &entry) {
+					if (entry.name == name && entry.max_size == max_size) {
+						entry.seen = true;
+						found      = true;
+					}
+				});
+
+				if (!found)
+					new (_alloc) Registered<Entry>(_entries, _env, *this, name, max_size);
+			});
+
+			_entries.for_each([&] (Registered<Entry> &entry) {
+				if (entry.seen)
+					return;
+
+				_release(entry);
+				destroy(_alloc, &entry);
+			});
+
+			if (restage)
+				_entries.for_each([&] (Entry &entry) {
+					if (!entry.staged())
+						_stage(entry); });
+		}
+
+		/**
+		 * Call 'fn(dma_addr, size, digest)' if the bitstream is cached
+		 *
+		 * \return  true if the bitstream is cached
+		 */
+		template <typename FN>
+		bool with_staged(Name const &name, FN const &fn)
+		{
+			Entry *staged = nullptr;
+			_entries.for_each([&] (Entry &entry) {
+				if (entry.name == name && entry.staged())
+					staged = &entry; });
+
+			if (!staged)
+				return false;
+
+			fn(staged->buffer->dma.dma_addr(), staged->size, staged->digest);
+			return true;
+		}
+
+		/**
+		 * Re-stage bitstream after its ROM changed
+		 *
+		 * Called by the user of the ROM to not depend on the order in which
+		 * ROM signals are delivered.
+		 */
+		void refresh(Name const &name)
+		{
+			_entries.for_each([&] (Entry &entry) {
+				if (entry.name == name)
+					entry.stage(); });
+		}
+
+		template <typename FN>
+		void for_each_entry(FN const &fn) const
+		{
+			_entries.for_each([&] (Entry const &entry) {
+				fn(entry.name, entry.staged(), entry.size, entry.digest); });
+		}
+
+		size_t budget() const { return _budget; }
+		size_t used()   const { return _used; }
+};
+
+#endif /* _DRIVERS__FPGA__BITSTREAM_CACHE_H_ */
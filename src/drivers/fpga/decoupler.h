@@ -0,0 +1,51 @@
+/*
+ * \brief  Driver for the Xilinx partial-reconfiguration decoupler
+ * \author agent
+ * \date   2026-10-18
+ *
+ * The decoupler isolates a reconfigurable region from the static design
+ * while the region is being reconfigured.
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _DRIVERS__FPGA__DECOUPLER_H_
+#define _DRIVERS__FPGA__DECOUPLER_H_
+
+#include <platform_session/device.h>
+
+namespace Fpga {
+	using namespace Genode;
+
+	struct Decoupler;
+}
+
+
+struct Fpga::Decoupler
+{
+	struct Mmio : Platform::Device::Mmio
+	{
+		struct Control : Register<0x0, 32>
+		{
+			struct Decouple : Bitfield<0,1> { };
+		};
+
+		Mmio(Platform::Device &device) : Platform::Device::Mmio(device) { }
+	};
+
+	Platform::Device device;
+	Mmio             mmio { device };
+
+	Decoupler(Platform::Connection &platform, Platform::Device::Name const &name)
+	: device(platform, name)
+	{ }
+
+	void decouple(bool enable) { mmio.write<Mmio::Control::Decouple>(enable); }
+};
+
+#endif /* _DRIVERS__FPGA__DECOUPLER_H_ */
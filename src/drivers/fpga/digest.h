@@ -0,0 +1,70 @@
+/*
+ * \brief  Digest of bitstream content
+ * \author agent
+ * \date   2026-10-18
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _DRIVERS__FPGA__DIGEST_H_
+#define _DRIVERS__FPGA__DIGEST_H_
+
+#include <base/stdint.h>
+#include <util/string.h>
+
+namespace Fpga {
+	using namespace Genode;
+
+	struct Digest;
+}
+
+
+/*
+ * 64-bit FNV-1a digest over 32-bit words
+ *
+ * Hashing words instead of bytes saves three quarters of the
+ * multiplications. The digest is only independent of how the content is
+ * split into pieces if all pieces but the last have a multiple of four
+ * bytes, which holds for the chunks of all load paths.
+ */
+struct Fpga::Digest
+{
+	enum : uint64_t { OFFSET = 0xcbf29ce484222325ULL, PRIME = 0x100000001b3ULL };
+
+	uint64_t value { OFFSET };
+
+	void update(void const *data, size_t len)
+	{
+		uint8_t const *bytes = (uint8_t const *)data;
+		uint64_t       hash  = value;
+
+		if (((addr_t)bytes & 0x3) == 0)
+			for (; len >= 4; len -= 4, bytes += 4)
+				hash = (hash ^ *(uint32_t const *)bytes) * PRIME;
+		else
+			for (; len >= 4; len -= 4, bytes += 4) {
+				uint32_t const word = bytes[0]        | (uint32_t)bytes[1] << 8 |
+				                      (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+				hash = (hash ^ word) * PRIME;
+			}
+
+		for (; len; len--, bytes++)
+			hash = (hash ^ *bytes) * PRIME;
+
+		value = hash;
+	}
+
+	bool operator == (Digest const &other) const { return value == other.value; }
+	bool operator != (Digest const &other) const { return value != other.value; }
+
+	using String = Genode::String<20>;
+
+	String string() const { return String(Hex(value)); }
+};
+
+#endif /* _DRIVERS__FPGA__DIGEST_H_ */
@@ -0,0 +1,319 @@
+/*
+ * \brief  Streaming decoder for LZ4-compressed bitstreams
+ * \author agent
+ * \date   2026-10-18
+ *
+ * The decoder processes the LZ4 frame format as produced by the 'lz4'
+ * command-line tool. It emits the decompressed data in pieces of arbitrary
+ * size and keeps the recent output in a window for resolving matches, hence
+ * the decompressed data is never materialised as a whole.
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _DRIVERS__FPGA__LZ4_H_
+#define _DRIVERS__FPGA__LZ4_H_
+
+#include <base/log.h>
+#include <util/string.h>
+#include <util/noncopyable.h>
+
+namespace Fpga {
+	using namespace Genode;
+
+	class Lz4_stream;
+}
+
+
+class Fpga::Lz4_stream : Noncopyable
+{
+	public:
+
+		struct Format_error : Exception { };
+
+		enum { MAGIC = 0x184d2204 };
+
+	private:
+
+		/*
+		 * Matches refer to at most 64 KiB of preceding output. A window of
+		 * twice the size ensures that the source and destination of a match
+		 * never overlap within the window.
+		 */
+		enum { WINDOW = 128*1024, MIN_MATCH = 4 };
+
+		enum State { TOKEN, LITERALS, OFFSET, MATCH };
+
+		uint8_t const * const _src;
+		size_t          const _src_size;
+		size_t                _pos { 0 };
+
+		bool     _block_checksum { false };
+		uint64_t _content_size   { 0 };
+
+		/* current block */
+		bool   _in_block  { false };
+		bool   _raw_block { false };
+		size_t _block_end { 0 };
+
+		State    _state    { TOKEN };
+		size_t   _literals { 0 };
+		size_t   _match    { 0 };
+		size_t   _offset   { 0 };
+		unsigned _nibble   { 0 };
+
+		bool _end    { false };
+		bool _failed { false };
+
+		uint8_t  _window[WINDOW];
+		uint64_t _total { 0 };
+
+		uint8_t _byte()
+		{
+			if (_pos < _src_size)
+				return _src[_pos++];
+
+			_failed = true;
+			return 0;
+		}
+
+		uint32_t _le32()
+		{
+			uint32_t value = 0;
+			for (unsigned i = 0; i < 4; i++)
+				value |= (uint32_t)_byte() << (8*i);
+			return value;
+		}
+
+		size_t _length(unsigned nibble)
+		{
+			size_t length = nibble;
+			if (nibble != 15)
+				return length;
+
+			for (uint8_t b = 255; b == 255 && !_failed; length += b)
+				b = _byte();
+
+			return length;
+		}
+
+		/* copy 'n' bytes to 'dst' and append them to the window */
+		void _emit(uint8_t *dst, uint8_t const *src, size_t n)
+		{
+			memcpy(dst, src, n);
+
+			size_t const to    = (size_t)(_total % WINDOW);
+			size_t const first = min(n, WINDOW - to);
+			memcpy(&_window[to], src, first);
+			memcpy(_window, src + first, n - first);
+
+			_total += n;
+		}
+
+		void _copy_match(uint8_t *dst, size_t n)
+		{
+			/* overlapping matches repeat the last '_offset' bytes */
+			while (n) {
+				size_t const from = (size_t)((_total - _offset) % WINDOW);
+				size_t const seg  = min(min(n, _offset), WINDOW - from);
+
+				_emit(dst, &_window[from], seg);
+				dst += seg;
+				n   -= seg;
+			}
+		}
+
+		void _next_block()
+		{
+			uint32_t const size = _le32();
+
+			/* end mark, an optional content checksum is not verified */
+			if (!size) {
+				_end = true;
+				return;
+			}
+
+			size_t const len = size & 0x7fffffff;
+			if (_failed || len > _src_size - _pos) {
+				_failed = true;
+				return;
+			}
+
+			_raw_block = size & 0x80000000;
+			_block_end = _pos + len;
+			_in_block  = true;
+			_state     = TOKEN;
+		}
+
+		void _finish_block()
+		{
+			if (_state != TOKEN)
+				_failed = true;
+
+			_pos      = _block_end + (_block_checksum ? 4 : 0);
+			_in_block = false;
+		}
+
+		/* decode next step of a compressed block */
+		size_t _decode(uint8_t *dst, size_t len)
+		{
+			switch (_state) {
+
+			case TOKEN:
+				{
+					if (_pos >= _block_end) {
+						_finish_block();
+						return 0;
+					}
+
+					uint8_t const token = _byte();
+					_nibble   = token & 0xf;
+					_literals = _length(token >> 4);
+					_state    = LITERALS;
+
+					if (_literals > _block_end - _pos)
+						_failed = true;
+					return 0;
+				}
+
+			case LITERALS:
+				{
+					size_t const n = min(_literals, len);
+					_emit(dst, &_src[_pos], n);
+					_pos      += n;
+					_literals -= n;
+
+					/* the last sequence of a block has no match */
+					if (!_literals)
+						_state = _pos >= _block_end ? TOKEN : OFFSET;
+					return n;
+				}
+
+			case OFFSET:
+				{
+					size_t const lo = _byte();
+					size_t const hi = _byte();
+					_offset = lo | (hi << 8);
+					_match  = _length(_nibble) + MIN_MATCH;
+					_state  = MATCH;
+
+					if (!_offset || _offset > _total)
+						_failed = true;
+					return 0;
+				}
+
+			case MATCH:
+				{
+					size_t const n = min(_match, len);
+					_copy_match(dst, n);
+					_match -= n;
+
+					if (!_match)
+						_state = TOKEN;
+					return n;
+				}
+			}
+
+			return 0;
+		}
+
+	public:
+
+		static bool detect(char const *buf, size_t size)
+		{
+			return size >= 4 && (uint8_t)buf[0] == 0x04 && (uint8_t)buf[1] == 0x22 &&
+			                    (uint8_t)buf[2] == 0x4d && (uint8_t)buf[3] == 0x18;
+		}
+
+		/**
+		 * Constructor
+		 *
+		 * \throw Format_error  not an LZ4 frame or unsupported frame options
+		 */
+		Lz4_stream(char const *src, size_t src_size)
+		: _src((uint8_t const *)src), _src_size(src_size)
+		{
+			if (_le32() != MAGIC)
+				throw Format_error();
+
+			uint8_t const flags = _byte();
+			_byte(); /* block maximum size, irrelevant for streaming */
+
+			if ((flags >> 6) != 1) {
+				error("unsupported LZ4 frame version");
+				throw Format_error();
+			}
+
+			if (flags & 0x1) {
+				error("LZ4 frames with dictionary are not supported");
+				throw Format_error();
+			}
+
+			_block_checksum = flags & 0x10;
+
+			if (flags & 0x08) {
+				uint64_t const lo = _le32();
+				uint64_t const hi = _le32();
+				_content_size = lo | (hi << 32);
+			}
+
+			_byte(); /* header checksum */
+
+			if (_failed)
+				throw Format_error();
+		}
+
+		/**
+		 * Size of the decompressed data, 0 if not stored in the frame
+		 */
+		size_t content_size() const { return (size_t)_content_size; }
+
+		bool failed() const { return _failed; }
+
+		/**
+		 * Decompress the next 'len' bytes into 'dst'
+		 *
+		 * \return  number of bytes, which is less than 'len' only at the
+		 *          end of the stream or on a decoding error
+		 */
+		size_t read(char *dst, size_t len)
+		{
+			uint8_t *out      = (uint8_t *)dst;
+			size_t   produced = 0;
+
+			while (produced < len && !_end && !_failed) {
+
+				if (!_in_block) {
+					_next_block();
+					continue;
+				}
+
+				if (_raw_block) {
+					size_t const n = min(len - produced, _block_end - _pos);
+					_emit(out + produced, &_src[_pos], n);
+					_pos     += n;
+					produced += n;
+
+					if (_pos == _block_end) {
+						_pos      = _block_end + (_block_checksum ? 4 : 0);
+						_in_block = false;
+					}
+					continue;
+				}
+
+				produced += _decode(out + produced, len - produced);
+			}
+
+			if (_failed)
+				error("corrupt LZ4 stream at offset ", Hex(_pos));
+
+			return produced;
+		}
+};
+
+#endif /* _DRIVERS__FPGA__LZ4_H_ */
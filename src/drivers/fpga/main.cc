@@ -17,80 +17,340 @@
 #include <base/attached_rom_dataspace.h>
 #include <util/reconstructible.h>
 #include <os/reporter.h>
+#include <base/registry.h>
 
 #include "pcap.h"
 #include "bitstream.h"
+#include "decoupler.h"
+#include "bitstream_cache.h"
+#include "scrubber.h"
 
 namespace Fpga {
 	using namespace Genode;
 
 	struct Managed_bitstream;
+	struct Region;
 	struct Main;
 }
 
-struct Fpga::Managed_bitstream
+struct Fpga::Managed_bitstream : Pcap_loader::Job
 {
-	using Name = String<128>;
+	using Name           = String<128>;
+	using Decoupler_name = Platform::Device::Name;
+
+	struct Action : Interface
+	{
+		/* return true if the bitstream may be loaded now */
+		virtual bool bitstream_loadable(Managed_bitstream const &) = 0;
+
+		virtual void bitstream_loaded(Managed_bitstream &) = 0;
+	};
+
+	enum Source { NONE, CACHE, COLD };
 
 	size_t                    max_size;
 	Name                      name;
+	bool                const partial;
+	Decoupler_name      const decoupler_name;
+	Pcap_loader              &loader;
+
+	/* time spent for obtaining the ROM and checking its content */
+	uint64_t                  rom_us    { loader.elapsed_us() };
+	uint64_t                  digest_us { 0 };
+
 	Attached_rom_dataspace    rom;
 	Constructible<Bitstream>  bitstream { };
-	Pcap_loader              &loader;
-	Reporter                 &reporter;
+	Constructible<Decoupler>  decoupler { };
+
+	/* copy of a RAW bitstream, which is loaded with a single DMA command */
+	Constructible<Platform::Dma_buffer> raw_buffer { };
+	Platform::Connection     &platform;
+	Bitstream_cache          &cache;
+	Action                   &action;
+	bool                      loaded { false };
+	Source                    source { NONE };
+
+	/*
+	 * Digest of the bitstream being loaded, which is only known after
+	 * streaming if the bitstream is loaded in chunks
+	 */
+	Digest                    digest        { };
+	bool                      streamed      { false };
+	Digest                    loaded_digest { };
 
 	Signal_handler<Managed_bitstream> rom_handler;
 
-	Managed_bitstream(Env &env, Pcap_loader &loader, Reporter &reporter, Name const &name, size_t max_size)
+	Managed_bitstream(Env                  &env,
+	                  Platform::Connection &platform,
+	                  Pcap_loader          &loader,
+	                  Bitstream_cache      &cache,
+	                  Action               &action,
+	                  Name           const &name,
+	                  size_t                max_size,
+	                  bool                  partial        = false,
+	                  Decoupler_name const &decoupler_name = Decoupler_name())
 	: max_size(max_size),
 	  name(name),
-	  rom(env, name.string()),
+	  partial(partial),
+	  decoupler_name(decoupler_name),
 	  loader(loader),
-	  reporter(reporter),
+	  rom(env, name.string()),
+	  platform(platform),
+	  cache(cache),
+	  action(action),
 	  rom_handler(env.ep(), *this, &Managed_bitstream::handle_rom)
 	{
-		handle_rom();
+		rom_us = loader.elapsed_us() - rom_us;
+
+		_check_and_load();
 
 		rom.sigh(rom_handler);
 	}
 
 	~Managed_bitstream()
 	{
-		/* report that we unload the bitstream */
-		report("", false);
+		loader.cancel(*this);
 
-		loader.reset();
+		if (decoupler.constructed())
+			decoupler->decouple(false);
+
+		/* a partial bitstream stays in its region until overwritten */
+		if (!partial)
+			loader.reset();
+	}
+
+	static char const *source_name(Source source)
+	{
+		switch (source) {
+		case CACHE: return "cache";
+		case COLD:  return "cold";
+		case NONE:  break;
+		}
+		return "none";
+	}
+
+	/**
+	 * Queue load at the PCAP loader, completion is reported to the action
+	 */
+	void load()
+	{
+		loaded = false;
+		source = NONE;
+
+		if (!action.bitstream_loadable(*this)) {
+			loader.cancel(*this);
+			return;
+		}
+
+		loader.load_bitstream(*this, partial);
+	}
+
+	/**
+	 * Compute digest of the current ROM content
+	 */
+	Digest content_digest()
+	{
+		Digest result { };
+		if (cache.with_staged(name, [&] (addr_t, size_t, Digest const &d) { result = d; }))
+			return result;
+
+		try {
+			bitstream.construct(rom, max_size);
+		} catch (Bitstream::Format_error) {
+			return result;
+		}
+
+		char buf[4096];
+		for (size_t offset = 0, n; (n = bitstream->read_bitstream(buf, offset, sizeof(buf))); )
+			offset += n;
+
+		result = bitstream->digest();
+		bitstream.destruct();
+		return result;
+	}
+
+	void _check_and_load()
+	{
+		/* ROMs may signal without any change of the content */
+		if (loaded) {
+			uint64_t const start     = loader.elapsed_us();
+			bool     const unchanged = content_digest() == loaded_digest;
+			digest_us = loader.elapsed_us() - start;
+
+			if (unchanged) {
+				log("bitstream ", name, " unchanged, skipping reload");
+				return;
+			}
+		} else
+			digest_us = 0;
+
+		load();
 	}
 
 	void handle_rom()
 	{
+		uint64_t const start = loader.elapsed_us();
 		rom.update();
+		cache.refresh(name);
+		rom_us = loader.elapsed_us() - start;
 
-		bitstream.construct(rom, max_size);
+		_check_and_load();
+	}
 
-		log("Loading bitstream ", name, " of size ", Hex(bitstream->size()));
+	/**
+	 * Report durations of the phases of the last load
+	 */
+	void report_timing(Xml_generator &xml) const
+	{
+		Pcap_loader::Job::Timing const &t = timing();
+
+		xml.attribute("load_us",    rom_us + digest_us + t.total_us);
+		xml.attribute("throughput", t.throughput());
+
+		xml.node("phases", [&] () {
+			xml.attribute("rom_us",      rom_us);
+			xml.attribute("digest_us",   digest_us);
+			xml.attribute("queued_us",   t.queued_us);
+			xml.attribute("prepare_us",  t.prepare_us);
+			xml.attribute("reset_us",    t.reset_us);
+			xml.attribute("alloc_us",    t.alloc_us);
+			xml.attribute("copy_us",     t.copy_us);
+			xml.attribute("transfer_us", t.transfer_us);
+			xml.attribute("done_us",     t.done_us);
+		});
+	}
 
-		bool loaded = loader.load_bitstream(bitstream->size(), [&] (char * buf, size_t buf_sz) {
-			return bitstream->read_bitstream(buf, buf_sz);
+
+	/********************************
+	 ** Pcap_loader::Job interface **
+	 ********************************/
+
+	Pcap_loader::Job::Source load_start() override
+	{
+		using Job_source = Pcap_loader::Job::Source;
+
+		Job_source result { 0, 0 };
+
+		/* pre-staged bitstreams are handed to the PCAP without any parsing */
+		bool const hit = cache.with_staged(name, [&] (addr_t dma_addr, size_t size,
+		                                              Digest const &staged_digest) {
+			log("Loading ", partial ? "partial " : "", "bitstream ", name,
+			    " of size ", Hex(size), " from cache");
+			result = Job_source { dma_addr, size };
+			digest = staged_digest;
 		});
 
-		report(name, loaded);
+		streamed = false;
+		raw_buffer.destruct();
+
+		if (hit)
+			source = CACHE;
+		else {
+			source   = COLD;
+			streamed = true;
+
+			try {
+				bitstream.construct(rom, max_size);
+			} catch (Bitstream::Format_error) {
+				return result;
+			}
+
+			log("Loading ", bitstream->compressed() ? "compressed " : "",
+			    partial ? "partial " : "",
+			    "bitstream ", name, " of size ", Hex(bitstream->size()));
+
+			result = Job_source { 0, bitstream->size() };
+
+			/*
+			 * The platform session provides DMA addresses only for its own
+			 * DMA buffers. A RAW bitstream is therefore copied once from the
+			 * ROM into a DMA buffer, which also computes the digest, and
+			 * handed to the PCAP as a whole. If the buffer cannot be
+			 * allocated, the bitstream is loaded in chunks.
+			 */
+			if (bitstream->raw()) {
+				try {
+					raw_buffer.construct(platform, bitstream->size(), UNCACHED);
+					bitstream->read_bitstream(raw_buffer->local_addr<char>(), 0,
+					                          bitstream->size());
+					result = Job_source { raw_buffer->dma_addr(), bitstream->size() };
+				} catch (...) {
+					raw_buffer.destruct();
+					warning("no DMA buffer for bitstream ", name,
+					        ", loading it in chunks");
+				}
+			}
+		}
+
+		/* isolate the region from the static design during reconfiguration */
+		if (partial && decoupler_name != "" && !decoupler.constructed()) {
+			try { decoupler.construct(platform, decoupler_name); }
+			catch (...) { warning("decoupler ", decoupler_name, " not available"); }
+		}
+
+		if (decoupler.constructed())
+			decoupler->decouple(true);
+
+		return result;
 	}
 
-	void report(Name const &name, bool loaded)
+	size_t read_chunk(char *dst, size_t offset, size_t len) override {
+		return bitstream->read_bitstream(dst, offset, len); }
+
+	void load_done(bool success) override
 	{
-		Reporter::Xml_generator xml(reporter, [&] () {
-			xml.node("bitstream", [&] () {
-				if (name != "")
-					xml.attribute("name", name);
-				xml.attribute("loaded", loaded);
-			});
-		});
+		loaded = success;
+
+		if (streamed && bitstream.constructed())
+			digest = bitstream->digest();
+
+		raw_buffer.destruct();
+
+		if (success)
+			loaded_digest = digest;
+
+		if (decoupler.constructed())
+			decoupler->decouple(false);
+
+		action.bitstream_loaded(*this);
 	}
+};
+
+
+/*
+ * Reconfigurable region of the static design
+ */
+struct Fpga::Region
+{
+	using Name = String<64>;
+
+	Name const name;
+	bool       seen { true };
+
+	Constructible<Managed_bitstream> bitstream { };
+
+	Region(Name const &name) : name(name) { }
 
+	void update(Env &env, Platform::Connection &platform, Pcap_loader &loader,
+	            Bitstream_cache &cache, Managed_bitstream::Action &action,
+	            Xml_node const &node)
+	{
+		Managed_bitstream::Name const new_name =
+			node.attribute_value("bitstream", Managed_bitstream::Name(""));
+		size_t const max_size = node.attribute_value("size", 0UL);
+
+		if (new_name == "")
+			bitstream.destruct();
+		else if (!bitstream.constructed() || new_name != bitstream->name)
+			bitstream.construct(env, platform, loader, cache, action, new_name, max_size, true,
+			                    node.attribute_value("decoupler", Managed_bitstream::Decoupler_name()));
+	}
+
+	bool loaded() const { return bitstream.constructed() && bitstream->loaded; }
 };
 
-struct Fpga::Main
+
+struct Fpga::Main : Managed_bitstream::Action, Scrubber::Action
 {
 	using Type   = Platform::Device::Type;
 
@@ -103,13 +363,108 @@ struct Fpga::Main
 
 	Constructible<Managed_bitstream>   managed_bitstream { };
 
+	Registry<Registered<Region>>       regions           { };
+
 	Reporter                           reporter          { env, "state" };
 
 	Platform::Connection               platform          { env };
-	Pcap_loader                        loader            { env, platform };
+	Pcap_loader                        loader            { env, platform, chunk_size_from_config() };
+	Bitstream_cache                    cache             { env, heap, platform, loader };
+
+	/* statistics on loaded bitstreams */
+	unsigned cache_hits { 0 };
+	unsigned cold_loads { 0 };
+
+	/* allocated while scrubbing is enabled only */
+	Scrubber                          *scrubber          { nullptr };
+
+	/* scrubbing is configured but paused by partial bitstreams */
+	bool                               scrub_paused      { false };
+
+	void destroy_scrubber()
+	{
+		if (scrubber)
+			destroy(heap, scrubber);
+		scrubber = nullptr;
+	}
+
+	size_t chunk_size_from_config()
+	{
+		return config_rom.xml().attribute_value("chunk_size",
+			Number_of_bytes { Pcap_loader::DEFAULT_CHUNK_SIZE });
+	}
+
+	/*
+	 * State of the full bitstream, which is updated by 'bitstream_loaded()'
+	 * already while 'managed_bitstream' is being constructed
+	 */
+	Managed_bitstream::Name full_name     { };
+	size_t                  full_max_size { 0 };
+	bool                    full_loaded   { false };
 
 	void handle_config();
 
+	void update_regions(Xml_node const &config);
+
+	void update_scrubber();
+
+	void report();
+
+
+	/*****************************************
+	 ** Managed_bitstream::Action interface **
+	 *****************************************/
+
+	bool bitstream_loadable(Managed_bitstream const &bitstream) override
+	{
+		/* the frames of the loaded design are about to change */
+		destroy_scrubber();
+
+		/* regions must wait for the pending full reconfiguration */
+		if (!bitstream.partial) {
+			full_loaded = false;
+			return true;
+		}
+
+		if (full_loaded)
+			return true;
+
+		warning("deferring partial bitstream ", bitstream.name,
+		        " until a full bitstream is loaded");
+		return false;
+	}
+
+	void bitstream_loaded(Managed_bitstream &bitstream) override
+	{
+		switch (bitstream.source) {
+		case Managed_bitstream::CACHE: cache_hits++; break;
+		case Managed_bitstream::COLD:  cold_loads++; break;
+		case Managed_bitstream::NONE:   break;
+		}
+
+		/* a full reconfiguration wipes all regions */
+		if (!bitstream.partial) {
+			full_name     = bitstream.name;
+			full_max_size = bitstream.max_size;
+			full_loaded   = bitstream.loaded;
+
+			regions.for_each([&] (Region &region) {
+				if (region.bitstream.constructed())
+					region.bitstream->load(); });
+		}
+
+		update_scrubber();
+
+		report();
+	}
+
+
+	/********************************
+	 ** Scrubber::Action interface **
+	 ********************************/
+
+	void scrub_progress() override { report(); }
+
 	Main(Env &env) : env(env)
 	{
 		loader.reset();
@@ -119,8 +474,6 @@ struct Fpga::Main
 		reporter.enabled(true);
 
 		handle_config();
-
-		/* TODO periodically read back bitstream to check integrity */
 	}
 };
 
@@ -129,22 +482,170 @@ void Fpga::Main::handle_config()
 {
 	config_rom.update();
 
+	/* stage candidates before loading to let the first switch hit the cache */
+	config_rom.xml().with_sub_node("cache",
+		[&] (Xml_node const &node) { cache.update(node); },
+		[&] ()                     { cache.update(Xml_node("<cache/>")); });
+
+	auto unload = [&] () {
+		if (!managed_bitstream.constructed())
+			return;
+
+		destroy_scrubber();
+		managed_bitstream.destruct();
+		full_name   = Managed_bitstream::Name();
+		full_loaded = false;
+
+		regions.for_each([&] (Region &region) {
+			if (!region.bitstream.constructed())
+				return;
+
+			loader.cancel(*region.bitstream);
+			region.bitstream->loaded = false;
+		});
+	};
+
 	config_rom.xml().with_sub_node("bitstream",
 		[&] (Xml_node const &xml) {
 			Managed_bitstream::Name new_name = xml.attribute_value("name", Managed_bitstream::Name(""));
 			size_t                  max_size = xml.attribute_value("size", 0);
 
 			if (new_name == "")
-				managed_bitstream.destruct();
-			else if (!managed_bitstream.constructed() || new_name != managed_bitstream->name)
-				managed_bitstream.construct(env, loader, reporter, new_name, max_size);
+				unload();
+			else if (!managed_bitstream.constructed() || new_name != managed_bitstream->name) {
+				unload();
+				managed_bitstream.construct(env, platform, loader, cache, *this, new_name, max_size);
+			}
 
 		},
 		[&] () {
 			warning("<bitstream> missing");
-			managed_bitstream.destruct();
+			unload();
 		}
 	);
+
+	update_regions(config_rom.xml());
+
+	/* restart scrubbing with the new parameters */
+	destroy_scrubber();
+	update_scrubber();
+
+	report();
+}
+
+
+void Fpga::Main::update_scrubber()
+{
+	/* partial bitstreams alter frames of the full bitstream */
+	bool regions_used = false;
+	regions.for_each([&] (Region const &region) {
+		if (region.bitstream.constructed())
+			regions_used = true; });
+
+	Xml_node const config = config_rom.xml();
+
+	bool const paused = full_loaded && regions_used && config.has_sub_node("scrub");
+	if (paused && !scrub_paused)
+		warning("scrubbing disabled while a <region> holds a partial bitstream");
+	scrub_paused = paused;
+
+	if (!full_loaded || regions_used || !config.has_sub_node("scrub")) {
+		destroy_scrubber();
+		return;
+	}
+
+	if (scrubber)
+		return;
+
+	config.with_sub_node("scrub",
+		[&] (Xml_node const &node) {
+			try {
+				scrubber = new (heap) Scrubber(env, platform, loader, *this,
+				                               full_name, full_max_size, node);
+			} catch (Scrubber::Invalid_bitstream) { }
+		},
+		[&] () { });
+}
+
+
+void Fpga::Main::update_regions(Xml_node const &config)
+{
+	regions.for_each([&] (Region &region) { region.seen = false; });
+
+	config.for_each_sub_node("region", [&] (Xml_node const &node) {
+		Region::Name const name = node.attribute_value("name", Region::Name());
+		if (name == "") {
+			warning("ignoring <region> without name");
+			return;
+		}
+
+		Region *region = nullptr;
+		regions.for_each([&] (Region &r) {
+			if (r.name == name) region = &r; });
+
+		if (!region)
+			region = new (heap) Registered<Region>(regions, name);
+
+		region->seen = true;
+		region->update(env, platform, loader, cache, *this, node);
+	});
+
+	regions.for_each([&] (Registered<Region> &region) {
+		if (!region.seen)
+			destroy(heap, &region); });
+}
+
+
+void Fpga::Main::report()
+{
+	Reporter::Xml_generator xml(reporter, [&] () {
+		xml.node("bitstream", [&] () {
+			if (full_name != "")
+				xml.attribute("name", full_name);
+			xml.attribute("loaded", full_loaded);
+			if (full_loaded && managed_bitstream.constructed()) {
+				xml.attribute("source", Managed_bitstream::source_name(managed_bitstream->source));
+				xml.attribute("digest", managed_bitstream->loaded_digest.string());
+				managed_bitstream->report_timing(xml);
+			}
+		});
+
+		regions.for_each([&] (Region const &region) {
+			xml.node("region", [&] () {
+				xml.attribute("name", region.name);
+				if (region.bitstream.constructed())
+					xml.attribute("bitstream", region.bitstream->name);
+				xml.attribute("loaded", region.loaded());
+				if (region.loaded()) {
+					xml.attribute("source", Managed_bitstream::source_name(region.bitstream->source));
+					xml.attribute("digest", region.bitstream->loaded_digest.string());
+					region.bitstream->report_timing(xml);
+				}
+			});
+		});
+
+		if (scrubber)
+			xml.node("scrub", [&] () { scrubber->report(xml); });
+
+		xml.node("cache", [&] () {
+			xml.attribute("budget",     cache.budget());
+			xml.attribute("used",       cache.used());
+			xml.attribute("hits",       cache_hits);
+			xml.attribute("cold_loads", cold_loads);
+
+			cache.for_each_entry([&] (Bitstream_cache::Name const &name,
+			                          bool staged, size_t size, Digest const &digest) {
+				xml.node("bitstream", [&] () {
+					xml.attribute("name",   name);
+					xml.attribute("staged", staged);
+					if (staged) {
+						xml.attribute("size",   size);
+						xml.attribute("digest", digest.string());
+					}
+				});
+			});
+		});
+	});
 }
 
 
@@ -15,7 +15,10 @@
 #define _DRIVERS__FPGA__PCAP_H_
 
 #include <platform_session/device.h>
+#include <timer_session/connection.h>
 #include <util/reconstructible.h>
+#include <util/lazy_array.h>
+#include <util/fifo.h>
 
 namespace Fpga {
 	using namespace Genode;
@@ -56,8 +59,10 @@ struct Fpga::Devcfg : Device::Mmio
 
 	struct Interrupts : Register<0x0C, 32>
 	{
-		struct Pfg_done : Bitfield< 2,1> { };
-		struct Dma_done : Bitfield<13,1> { };
+		struct Pfg_done    : Bitfield< 2,1> { };
+		struct Pfg_init_ne : Bitfield< 3,1> { };
+		struct Pfg_init_pe : Bitfield< 4,1> { };
+		struct Dma_done    : Bitfield<13,1> { };
 
 		struct Seu_err       : Bitfield< 5,1> { };
 		struct Hmac_err      : Bitfield< 6,1> { };
@@ -73,6 +78,9 @@ struct Fpga::Devcfg : Device::Mmio
 	                            Bitset_2<Axi_rd_err, Axi_wr_err>> { };
 	};
 
+	/* interrupts are masked by set bits */
+	struct Int_mask : Register<0x10, 32> { };
+
 	struct Status : Register<0x14, 32>
 	{
 		struct Pfg_init  : Bitfield< 4,1> { };
@@ -115,10 +123,13 @@ struct Fpga::Devcfg : Device::Mmio
 };
 
 
+
+
 struct Fpga::Devcfg_driver
 {
-	Device device;
-	Devcfg devcfg { device };
+	Device      device;
+	Devcfg      devcfg { device };
+	Device::Irq irq    { device };
 
 	Devcfg_driver(Platform::Connection &platform)
 	: device(platform, Device::Type { "xlnx,zynq-devcfg-1.0" })
@@ -126,13 +137,130 @@ struct Fpga::Devcfg_driver
 };
 
 
+/*
+ * Asynchronous loader for bitstreams
+ *
+ * Loads are submitted as jobs, which are processed one after another by a
+ * state machine on the entrypoint. The state machine advances on the devcfg
+ * interrupt. Each phase is bounded by a timeout.
+ */
 class Fpga::Pcap_loader
 {
+	public:
+
+		/**
+		 * Bitstream load or readback submitted to the loader
+		 */
+		class Job : public Fifo<Job>::Element, Interface
+		{
+			public:
+
+				/*
+				 * Optional readback following the bitstream, which then
+				 * consists of configuration commands only. After the
+				 * readback, the trailer commands are sent, e.g., to
+				 * desynchronise the configuration logic.
+				 */
+				struct Readback
+				{
+					addr_t dma_addr     { 0 };
+					size_t size         { 0 };
+					addr_t trailer_addr { 0 };
+					size_t trailer_size { 0 };
+				};
+
+				struct Source
+				{
+					addr_t   dma_addr;  /* 0 if loaded via 'read_chunk()' */
+					size_t   size;      /* 0 if the bitstream is not loadable */
+					Readback readback { };
+				};
+
+				/*
+				 * Durations of the phases of the last run of the job
+				 *
+				 * Copying overlaps with the transfer because chunks are
+				 * copied while the PCAP consumes the previous batch.
+				 */
+				struct Timing
+				{
+					uint64_t queued_us   { 0 };  /* waiting for preceding jobs */
+					uint64_t prepare_us  { 0 };  /* 'load_start()', e.g., parsing */
+					uint64_t reset_us    { 0 };
+					uint64_t alloc_us    { 0 };  /* allocation of chunk buffers */
+					uint64_t copy_us     { 0 };  /* 'read_chunk()' */
+					uint64_t transfer_us { 0 };  /* PCAP DMA incl. readback */
+					uint64_t done_us     { 0 };  /* wait for PL done */
+					uint64_t total_us    { 0 };  /* from start to completion */
+					size_t   bytes       { 0 };
+
+					/* bytes per second transferred to the PCAP */
+					uint64_t throughput() const {
+						return transfer_us ? ((uint64_t)bytes * 1000000) / transfer_us : 0; }
+				};
+
+			private:
+
+				friend class Pcap_loader;
+
+				size_t   _size         { 0 };
+				addr_t   _dma_addr     { 0 };
+				bool     _partial      { false };
+				Readback _readback     { };
+				Timing   _timing       { };
+				uint64_t _submitted_us { 0 };
+
+			public:
+
+				Timing const &timing() const { return _timing; }
+
+				/**
+				 * Called when the job is started
+				 *
+				 * The source is determined not before the job is started
+				 * because the memory of a pending job may vanish meanwhile.
+				 */
+				virtual Source load_start() = 0;
+
+				/**
+				 * Copy 'len' bytes of the bitstream at 'offset' into 'dst'
+				 *
+				 * Only called for jobs not loaded from DMA-capable memory.
+				 *
+				 * \return  number of bytes copied
+				 */
+				virtual size_t read_chunk(char *dst, size_t offset, size_t len) = 0;
+
+				/**
+				 * Called once the job finished or failed
+				 */
+				virtual void load_done(bool success) = 0;
+		};
+
 	private:
+
+		/* timeouts of the individual phases */
+		enum {
+			RESET_TIMEOUT_US = 100*1000,
+			DONE_TIMEOUT_US  = 100*1000,
+			DRAIN_TIMEOUT_US = 1000*1000,
+
+			/* a batch must at least be transferred at 10 MB/s */
+			DMA_TIMEOUT_BASE_US      = 10*1000,
+			DMA_TIMEOUT_BYTES_PER_US = 10,
+		};
+
 		Env                         &_env;
 		Platform::Connection        &_platform;
+		Timer::Connection            _timer { _env };
 		Constructible<Devcfg_driver> _driver { };
 
+		Signal_handler<Pcap_loader>          _irq_handler {
+			_env.ep(), *this, &Pcap_loader::_handle_irq };
+
+		Timer::One_shot_timeout<Pcap_loader> _timeout {
+			_timer, *this, &Pcap_loader::_handle_timeout };
+
 		struct Dma_buffer
 		{
 			Platform::Connection       &_platform;
@@ -151,69 +279,150 @@ class Fpga::Pcap_loader
 			char *local_addr() { return (char*)_ds.local_addr<addr_t>(); };
 		};
 
-		bool _device_valid() {
-			if (!_driver.constructed())
+		/*
+		 * The DMA done counter saturates at three and can only be cleared
+		 * as a whole. Hence, at most three chunks are queued at once and the
+		 * counter is cleared after all of them completed.
+		 */
+		enum { BATCH = 3 };
+
+		using Chunks = Lazy_array<Dma_buffer, 2*BATCH>;
+
+		size_t const _chunk_size;
+
+		/*
+		 * A full load passes RESET_LOW and RESET_HIGH, whereas a partial
+		 * load starts streaming right away. A reset job ends after the
+		 * reset. Only a full load waits for the PL to signal done. A
+		 * readback job continues with READBACK and TRAILER after
+		 * streaming the commands.
+		 */
+		enum State { IDLE, RESET_LOW, RESET_HIGH, STREAM, DONE_WAIT, READBACK, TRAILER };
+
+		State       _state   { IDLE };
+		Fifo<Job>   _queue   { };
+		Job        *_current { nullptr };
+
+		/* notified whenever a job stopped accessing its memory */
+		Signal_context_capability _job_done_sigh { };
+
+		void _notify_job_done()
+		{
+			if (_job_done_sigh.valid())
+				Signal_transmitter(_job_done_sigh).submit();
+		}
+
+		struct Reset_job : Job
+		{
+			Source load_start() override { return Source { 0, 0 }; }
+			size_t read_chunk(char *, size_t, size_t) override { return 0; }
+			void   load_done(bool) override { }
+		} _reset_job { };
+
+		/* start of the current job and of its current phase */
+		uint64_t _job_start   { 0 };
+		uint64_t _phase_start { 0 };
+
+		uint64_t _now() { return _timer.elapsed_us(); }
+
+		/* state of the current chunked load */
+		Constructible<Chunks> _chunks { };
+		size_t                _offset { 0 };
+		size_t                _lengths[2][BATCH] { };
+		unsigned              _batch     { 0 };
+		unsigned              _in_flight { 0 };
+
+		Devcfg::Mmio &devcfg() {
+			return _driver->devcfg; }
+
+		bool _device_valid()
+		{
+			if (!_driver.constructed()) {
 				_driver.construct(_platform);
+				_driver->irq.sigh(_irq_handler);
+			}
 
 			return devcfg().read<Devcfg::Mctrl::Version>() > 0;
 		}
 
-		Devcfg::Mmio &devcfg() {
-			return _driver->devcfg;
+		static Devcfg::Interrupts::access_t _errors()
+		{
+			Devcfg::Interrupts::access_t bits = 0;
+			Devcfg::Interrupts::Errors::set(bits, ~0U);
+			return bits;
 		}
 
-	public:
+		/* unmask the errors and the 'event' the current phase waits for */
+		void _wait_for(Devcfg::Interrupts::access_t event, uint64_t timeout_us)
+		{
+			devcfg().write<Devcfg::Int_mask>(~(event | _errors()));
+			_timeout.schedule(Microseconds { timeout_us });
+		}
 
-		Pcap_loader(Env                    &env,
-		            Platform::Connection   &platform)
-		: _env(env), _platform(platform)
-		{ }
+		/* clear the given bits of the write-one-to-clear interrupt status */
+		void _clear(Devcfg::Interrupts::access_t bits) {
+			devcfg().write<Devcfg::Interrupts>(bits); }
 
-		/**
-		 * Reset PL by following the sequence from
-		 * ug585-Zynq-7000-TRM v1.13 p.212+213.
-		 */
-		void reset()
+		template <typename FIELD>
+		static Devcfg::Interrupts::access_t _bit()
 		{
-			if (!_device_valid()) {
-				error("Invalid devcfg device");
-				return;
-			}
+			Devcfg::Interrupts::access_t bits = 0;
+			FIELD::set(bits, 1);
+			return bits;
+		}
 
-			/* uboot adds a 5ms delay between PROG_B high and low if efuse is selected */
-			if (devcfg().read<Devcfg::Ctrl::Efuse>())
-				warning("AES efuse selected as key source, potentially needs a delay");
+		void _queue_dma_command(addr_t src, addr_t dst, size_t src_len, size_t dst_len)
+		{
+			/* at most BATCH commands are queued, the queue holds more */
+			if (devcfg().read<Devcfg::Status::Dma_full>())
+				warning("DMA command queue unexpectedly full");
 
-			devcfg().write<Devcfg::Ctrl::Prog_b>(1);
-			devcfg().write<Devcfg::Ctrl::Prog_b>(0);
+			devcfg().write<Devcfg::Dma_src>(src);
+			devcfg().write<Devcfg::Dma_dst>(dst);
 
-			while (devcfg().read<Devcfg::Status::Pfg_init>());
+			/* set DMA source length (32bit words) */
+			devcfg().write<Devcfg::Dma_src_len::Words>(src_len >> 2);
 
-			devcfg().write<Devcfg::Ctrl::Prog_b>(1);
-			devcfg().write<Devcfg::Interrupts::Pfg_done>(1);
+			/* set DMA destination length - finalises DMA command */
+			devcfg().write<Devcfg::Dma_dst_len::Words>(dst_len >> 2);
 
-			while (!devcfg().read<Devcfg::Status::Pfg_init>());
+			_in_flight++;
 		}
-		
 
-		template <typename TRANSFER>
-		bool load_bitstream(size_t size, TRANSFER && transfer)
+		/* queue DMA command for a chunk, the last chunk waits for PCAP done */
+		void _queue_dma(addr_t dma_addr, size_t len, bool last)
 		{
-			if (!_device_valid()) {
-				error("Invalid devcfg device");
-				return false;
-			}
+			_queue_dma_command(last ? dma_addr | Devcfg::Dma_src::WAIT_FOR_PCAP_DONE
+			                        : dma_addr,
+			                   Devcfg::Dma_dst::FPGA, len, len);
+		}
 
-			/* allocate DMA buffer */
-			Dma_buffer dma_buf { _env, _platform, size };
+		/* queue DMA command reading 'len' bytes from the PCAP */
+		void _queue_readback(addr_t dma_addr, size_t len) {
+			_queue_dma_command(Devcfg::Dma_src::FPGA, dma_addr, 0, len); }
 
-			/* copy bitstream into DMA buffer */
-			size_t transferred = transfer(dma_buf.local_addr(), size);
-			if (transferred != size) {
-				error("Failed copying ", size, " bytes to DMA buffer");
+		/* wait for commands in flight, return true if all completed */
+		bool _dma_completed()
+		{
+			/* each command raises DMA done, only complete batches count */
+			_clear(_bit<Devcfg::Interrupts::Dma_done>());
+			if (devcfg().read<Devcfg::Status::Dma_count>() < _in_flight)
 				return false;
-			}
-			
+
+			devcfg().write<Devcfg::Status::Dma_count>(0x3);
+			_in_flight = 0;
+			return true;
+		}
+
+		void _wait_for_dma(size_t len) {
+			_wait_for(_bit<Devcfg::Interrupts::Dma_done>(),
+			          DMA_TIMEOUT_BASE_US + len / DMA_TIMEOUT_BYTES_PER_US); }
+
+		/*
+		 * Prepare PCAP interface for a new bitstream
+		 */
+		void _setup_interface()
+		{
 			/* enable PCAP interface */
 			devcfg().write<Devcfg::Ctrl::Mode>     (Devcfg::Ctrl::Mode::ENABLE);
 			devcfg().write<Devcfg::Ctrl::Interface>(Devcfg::Ctrl::Interface::PCAP);
@@ -223,10 +432,13 @@ class Fpga::Pcap_loader
 
 			/* clear interrupts */
 			devcfg().write<Devcfg::Interrupts>(~0U);
+		}
 
-			/* reset the PL */
-			reset();
-
+		/*
+		 * Prepare devcfg DMA after an optional reset
+		 */
+		bool _setup_dma()
+		{
 			/* check RX fifo status */
 			if (devcfg().read<Devcfg::Interrupts::Errors>()) {
 				error("Fatal error: ", Hex(devcfg().read<Devcfg::Interrupts::Errors>()));
@@ -249,7 +461,7 @@ class Fpga::Pcap_loader
 				}
 
 				/* clear out status */
-				devcfg().write<Devcfg::Interrupts::Dma_done>(1);
+				_clear(_bit<Devcfg::Interrupts::Dma_done>());
 			}
 
 			if (devcfg().read<Devcfg::Status::Dma_count>())
@@ -258,35 +470,449 @@ class Fpga::Pcap_loader
 			/* set PCAP clock divider to the rate expected in non-secure mode */
 			devcfg().write<Devcfg::Ctrl::Rate>(Devcfg::Ctrl::Rate::NORMAL);
 
-			/* set DMA source address */
-			devcfg().write<Devcfg::Dma_src>(dma_buf._dma_addr | Devcfg::Dma_src::WAIT_FOR_PCAP_DONE);
+			return true;
+		}
+
+		/* copy up to BATCH chunks into the buffers of batch 'b' */
+		bool _prepare(unsigned b)
+		{
+			size_t const chunk_size = _chunks->value(0)._ds.size();
 
-			/* set DMA destination address = FPGA */
-			devcfg().write<Devcfg::Dma_dst>(Devcfg::Dma_dst::FPGA);
+			for (unsigned i = 0; i < BATCH; i++) {
+				size_t const len = min(chunk_size, _current->_size - _offset);
+				_lengths[b][i] = len;
+				if (!len)
+					continue;
 
-			/* set DMA source length (32bit words */
-			devcfg().write<Devcfg::Dma_src_len::Words>(size >> 2);
+				Dma_buffer &chunk = _chunks->value(b*BATCH + i);
 
-			/* set DMA destination length - finalises DMA command */
-			devcfg().write<Devcfg::Dma_dst_len::Words>(size >> 2);
+				uint64_t const start  = _now();
+				size_t   const copied = _current->read_chunk(chunk.local_addr(), _offset, len);
+				_current->_timing.copy_us += _now() - start;
+
+				if (copied != len) {
+					error("Failed copying ", len, " bytes at offset ",
+					      Hex(_offset), " to DMA buffer");
+					return false;
+				}
+				_offset += len;
+			}
+			return true;
+		}
 
-			/* wait for DMA done bit (includes PCAP done) */
-			while (!devcfg().read<Devcfg::Interrupts::Dma_done>()) {};
+		/* queue the prepared batch and copy the next one meanwhile */
+		bool _queue_batch()
+		{
+			size_t bytes = 0;
+			for (unsigned i = 0; i < BATCH && _lengths[_batch][i]; i++) {
+				Dma_buffer &chunk = _chunks->value(_batch*BATCH + i);
+				bool const  last  = _offset == _current->_size &&
+				                    (i + 1 == BATCH || !_lengths[_batch][i + 1]) &&
+				                    !_current->_readback.size;
+
+				_queue_dma(chunk._dma_addr, _lengths[_batch][i], last);
+				bytes += _lengths[_batch][i];
+			}
 
-			/* check for errors */
-			bool failed = devcfg().read<Devcfg::Interrupts::Errors>();
+			_wait_for_dma(bytes);
 
-			/* make sure the PL is done */
-			if (!failed) {
-				while (!devcfg().read<Devcfg::Interrupts::Pfg_done>());
+			/* copy the next batch while the PCAP consumes the current one */
+			_batch = !_batch;
+			return _prepare(_batch);
+		}
 
-				_driver.destruct();
-			} else {
+		void _start_stream()
+		{
+			if (!_setup_dma()) {
+				_complete(false);
+				return;
+			}
+
+			_state       = STREAM;
+			_in_flight   = 0;
+			_phase_start = _now();
+
+			/* bitstream in DMA-capable memory is loaded by a single command */
+			if (_current->_dma_addr) {
+				_queue_dma(_current->_dma_addr, _current->_size, !_current->_readback.size);
+				_wait_for_dma(_current->_size);
+				return;
+			}
+
+			/* allocate chunk buffers for two batches */
+			size_t const chunk_size = min(_chunk_size, align_addr(_current->_size, 2));
+			_chunks.construct(2*BATCH, _env, _platform, chunk_size);
+
+			_current->_timing.alloc_us = _now() - _phase_start;
+			_phase_start               = _now();
+
+			_offset = 0;
+			_batch  = 0;
+
+			if (!_prepare(_batch) || !_queue_batch())
+				_complete(false);
+		}
+
+		void _start_next()
+		{
+			while (_state == IDLE && !_current) {
+
+				_queue.dequeue([&] (Job &job) { _current = &job; });
+				if (!_current)
+					return;
+
+				if (!_device_valid()) {
+					error("Invalid devcfg device");
+					_complete(false);
+					continue;
+				}
+
+				_job_start = _now();
+				_current->_timing.queued_us = _job_start - _current->_submitted_us;
+
+				Job::Source const source = _current->load_start();
+				_current->_dma_addr = source.dma_addr;
+				_current->_size     = source.size;
+				_current->_readback = source.readback;
+
+				_current->_timing.prepare_us = _now() - _job_start;
+				_current->_timing.bytes      = source.size;
+
+				if (!source.size && _current != &_reset_job) {
+					_complete(false);
+					continue;
+				}
+
+				_setup_interface();
+
+				if (_current->_partial) {
+					_start_stream();
+					continue;
+				}
+
+				/* reset the PL following ug585-Zynq-7000-TRM v1.13 p.212+213 */
+
+				/* uboot adds a 5ms delay between PROG_B high and low if efuse is selected */
+				if (devcfg().read<Devcfg::Ctrl::Efuse>())
+					warning("AES efuse selected as key source, potentially needs a delay");
+
+				_state       = RESET_LOW;
+				_phase_start = _now();
+				_clear(_bit<Devcfg::Interrupts::Pfg_init_ne>());
+				devcfg().write<Devcfg::Ctrl::Prog_b>(1);
+				devcfg().write<Devcfg::Ctrl::Prog_b>(0);
+				_wait_for(_bit<Devcfg::Interrupts::Pfg_init_ne>(), RESET_TIMEOUT_US);
+				_step();
+			}
+		}
+
+		/*
+		 * Advance the state machine as far as the device state permits
+		 */
+		void _step()
+		{
+			if (_state == IDLE)
+				return;
+
+			if (devcfg().read<Devcfg::Interrupts::Errors>()) {
+				_complete(false);
+				return;
+			}
+
+			for (;;) {
+				switch (_state) {
+				case IDLE:
+					return;
+
+				case RESET_LOW:
+					if (devcfg().read<Devcfg::Status::Pfg_init>())
+						return;
+
+					_state = RESET_HIGH;
+					_clear(_bit<Devcfg::Interrupts::Pfg_init_pe>());
+					devcfg().write<Devcfg::Ctrl::Prog_b>(1);
+					_clear(_bit<Devcfg::Interrupts::Pfg_done>());
+					_wait_for(_bit<Devcfg::Interrupts::Pfg_init_pe>(), RESET_TIMEOUT_US);
+					continue;
+
+				case RESET_HIGH:
+					if (!devcfg().read<Devcfg::Status::Pfg_init>())
+						return;
+
+					_current->_timing.reset_us = _now() - _phase_start;
+
+					if (!_current->_size) {
+						_complete(true);
+						return;
+					}
+
+					_start_stream();
+					continue;
+
+				case STREAM:
+					if (!_dma_completed())
+						return;
+
+					if (_chunks.constructed() && _lengths[_batch][0]) {
+						if (!_queue_batch()) {
+							_complete(false);
+							return;
+						}
+						continue;
+					}
+
+					if (_current->_readback.size) {
+						_state = READBACK;
+						_queue_readback(_current->_readback.dma_addr, _current->_readback.size);
+						_wait_for_dma(_current->_readback.size);
+						continue;
+					}
+
+					/*
+					 * The last command of a partial bitstream waited for
+					 * PCAP done already, the DONE signal of the PL remains
+					 * high.
+					 */
+					if (_current->_partial) {
+						_complete(true);
+						return;
+					}
+
+					_current->_timing.transfer_us = _now() - _phase_start;
+					_phase_start                  = _now();
+
+					_state = DONE_WAIT;
+					_wait_for(_bit<Devcfg::Interrupts::Pfg_done>(), DONE_TIMEOUT_US);
+					continue;
+
+				case READBACK:
+					if (!_dma_completed())
+						return;
+
+					if (!_current->_readback.trailer_size) {
+						_complete(true);
+						return;
+					}
+
+					_state = TRAILER;
+					_queue_dma(_current->_readback.trailer_addr,
+					           _current->_readback.trailer_size, false);
+					_wait_for_dma(_current->_readback.trailer_size);
+					continue;
+
+				case TRAILER:
+					if (!_dma_completed())
+						return;
+
+					_complete(true);
+					return;
+
+				case DONE_WAIT:
+					if (!devcfg().read<Devcfg::Interrupts::Pfg_done>())
+						return;
+
+					_complete(true);
+					return;
+				}
+			}
+		}
+
+		void _complete(bool success)
+		{
+			_timeout.discard();
+
+			if (success)
+				devcfg().write<Devcfg::Int_mask>(~0U);
+			else if (_driver.constructed()) {
+				devcfg().write<Devcfg::Int_mask>(~0U);
 				error("loading failed: ", Hex(devcfg().read<Devcfg::Interrupts>()));
 			}
 
-			return !failed;
+			Job &job = *_current;
+
+			uint64_t const now = _now();
+			switch (_state) {
+			case STREAM: case READBACK: case TRAILER:
+				job._timing.transfer_us = now - _phase_start; break;
+			case DONE_WAIT:
+				job._timing.done_us     = now - _phase_start; break;
+			default: break;
+			}
+			job._timing.total_us = now - _job_start;
+
+			_current = nullptr;
+			_state   = IDLE;
+			_chunks.destruct();
+
+			/* release the device unless further jobs are pending */
+			if (success && _queue.empty())
+				_driver.destruct();
+
+			_notify_job_done();
+
+			job.load_done(success);
+
+			_start_next();
+		}
+
+		void _handle_irq()
+		{
+			if (!_driver.constructed())
+				return;
+
+			_step();
+
+			/* the driver is released once the last job completed */
+			if (_driver.constructed())
+				_driver->irq.ack();
+		}
+
+		void _handle_timeout(Duration)
+		{
+			if (_state == IDLE)
+				return;
+
+			_step();
+			if (_state == IDLE)
+				return;
+
+			error("timeout in PCAP state ", (unsigned)_state);
+			_drain();
+			_complete(false);
+		}
+
+		/*
+		 * Wait until the DMA stopped accessing the memory of the current job
+		 *
+		 * This is the only busy wait, which is bounded and only needed if
+		 * a running load is cancelled or timed out. Memory of the current
+		 * job that is merely replaced, e.g., a cached bitstream, is released
+		 * on the 'job_done_sigh' signal instead.
+		 */
+		void _drain()
+		{
+			if (_state == IDLE || _state == RESET_LOW || _state == RESET_HIGH ||
+			    _state == DONE_WAIT || !_driver.constructed())
+				return;
+
+			uint64_t const start = _timer.elapsed_us();
+			while (!devcfg().read<Devcfg::Status::Dma_empty>())
+				if (_timer.elapsed_us() - start > DRAIN_TIMEOUT_US) {
+					error("DMA did not drain, reset PL");
+					devcfg().write<Devcfg::Ctrl::Prog_b>(0);
+					return;
+				}
+		}
+
+		void _submit(Job &job, bool partial)
+		{
+			cancel(job);
+
+			job._partial      = partial;
+			job._timing       = Job::Timing();
+			job._submitted_us = _now();
+			_queue.enqueue(job);
+
+			_start_next();
+		}
+
+	public:
+
+		enum { DEFAULT_CHUNK_SIZE = 64*1024 };
+
+		Pcap_loader(Env                    &env,
+		            Platform::Connection   &platform,
+		            size_t                  chunk_size = DEFAULT_CHUNK_SIZE)
+		: _env(env), _platform(platform),
+		  _chunk_size(max(align_addr(chunk_size, 2), (size_t)4096))
+		{ }
+
+		~Pcap_loader()
+		{
+			if (_current)
+				_drain();
+		}
+
+		/**
+		 * Time base used for the timing of jobs
+		 */
+		uint64_t elapsed_us() { return _now(); }
+
+		/**
+		 * Timer session of the loader, shared with the users of the loader
+		 */
+		Timer::Connection &timer() { return _timer; }
+
+		/**
+		 * Reset PL
+		 *
+		 * The reset is queued like a load and thus happens asynchronously.
+		 */
+		void reset()
+		{
+			if (_reset_job.enqueued() || _current == &_reset_job)
+				return;
+
+			_submit(_reset_job, false);
 		}
+
+		/**
+		 * Queue bitstream load
+		 *
+		 * A bitstream in DMA-capable memory is loaded by a single DMA
+		 * command. Otherwise, the bitstream is streamed through a small set
+		 * of chunk buffers. The chunks are queued in batches at the DMA
+		 * command queue of the devcfg device. Whereas the PCAP consumes one
+		 * batch, the next batch is copied via 'job.read_chunk()'. If
+		 * 'partial' is set, the bitstream is loaded without resetting the
+		 * PL. A pending load of the same job is replaced.
+		 */
+		void load_bitstream(Job &job, bool partial = false) {
+			_submit(job, partial); }
+
+		/**
+		 * Withdraw job, the job is not notified
+		 */
+		void cancel(Job &job)
+		{
+			if (job.enqueued())
+				_queue.remove(job);
+
+			if (_current != &job)
+				return;
+
+			_timeout.discard();
+			_drain();
+
+			if (_driver.constructed())
+				devcfg().write<Devcfg::Int_mask>(~0U);
+
+			_current = nullptr;
+			_state   = IDLE;
+			_chunks.destruct();
+
+			_notify_job_done();
+
+			_start_next();
+		}
+
+		/**
+		 * Register handler for the completion or cancellation of jobs
+		 *
+		 * Once the signal arrives, memory that was passed to the loader
+		 * via 'Job::Source::dma_addr' can be released unless
+		 * 'reads_from()' still reports it.
+		 */
+		void job_done_sigh(Signal_context_capability sigh) {
+			_job_done_sigh = sigh; }
+
+		/**
+		 * Return true if the current job may access memory at 'dma_addr'
+		 */
+		bool reads_from(addr_t dma_addr) const {
+			return _current && _current->_dma_addr == dma_addr; }
+
+		bool busy() const { return _current != nullptr; }
 };
 
 #endif /* _DRIVERS__FPGA__PCAP_H_ */
@@ -0,0 +1,574 @@
+/*
+ * \brief  Background readback and scrubbing of the PL configuration
+ * \author agent
+ * \date   2026-10-18
+ *
+ * The scrubber reads back the configuration frames step by step via the
+ * PCAP and compares them against the frame data of the loaded bitstream.
+ * Steps are spaced to not exceed the configured bandwidth. Frames that
+ * differ are optionally rewritten from the bitstream.
+ *
+ * A scrubber holds two frame streams and the frames of a step, which sums
+ * up to more than half a MiB. It is therefore allocated from the heap only
+ * while scrubbing is enabled.
+ */
+
+/*
+ * Copyright (C) 2023 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _DRIVERS__FPGA__SCRUBBER_H_
+#define _DRIVERS__FPGA__SCRUBBER_H_
+
+#include <base/attached_rom_dataspace.h>
+#include <platform_session/dma_buffer.h>
+#include <timer_session/connection.h>
+#include <util/xml_node.h>
+#include <util/xml_generator.h>
+#include <cpu/cache.h>
+
+/* local includes */
+#include "bitstream.h"
+#include "pcap.h"
+
+namespace Fpga {
+	using namespace Genode;
+
+	class Frame_stream;
+	class Scrubber;
+}
+
+
+/*
+ * Sequential reader of the frame data written to FDRI by a bitstream
+ */
+class Fpga::Frame_stream
+{
+	public:
+
+		/* configuration packets of 7-series devices (UG470) */
+		enum : uint32_t {
+			SYNC       = 0xaa995566,
+			TYPE1      = 1,
+			TYPE2      = 2,
+			OP_WRITE   = 2,
+			REG_FAR    = 1,
+			REG_FDRI   = 2,
+			FRAME_WORDS = 101,
+		};
+
+		struct Format_error : Exception { };
+
+	private:
+
+		enum { BUF_WORDS = 1024, HEADER_WORDS = 64*1024 };
+
+		Bitstream _bitstream;
+
+		uint32_t _buf[BUF_WORDS];
+		size_t   _pos    { 0 };  /* next word within '_buf' */
+		size_t   _fill   { 0 };  /* valid words within '_buf' */
+		size_t   _offset { 0 };  /* bytes read from the bitstream */
+
+		uint32_t _far       { 0 };
+		size_t   _words     { 0 };
+		size_t   _remaining { 0 };
+
+		bool _word(uint32_t &word)
+		{
+			if (_pos == _fill) {
+				size_t const n = _bitstream.read_bitstream((char *)_buf, _offset, sizeof(_buf));
+				_offset += n;
+				_pos     = 0;
+				_fill    = n / 4;
+				if (!_fill)
+					return false;
+			}
+
+			word = _buf[_pos++];
+			return true;
+		}
+
+		/* parse packets up to the frame data, the start address is kept */
+		void _locate()
+		{
+			uint32_t word = 0;
+			size_t   count = 0;
+
+			while (word != SYNC)
+				if (!_word(word) || ++count > HEADER_WORDS)
+					throw Format_error();
+
+			unsigned reg = 0;
+			while (count++ < HEADER_WORDS && _word(word)) {
+
+				unsigned const type = word >> 29;
+				unsigned const op   = (word >> 27) & 0x3;
+				size_t         len  = 0;
+
+				if (type == TYPE1) {
+					reg = (word >> 13) & 0x3fff;
+					len = word & 0x7ff;
+				} else if (type == TYPE2)
+					len = word & 0x7ffffff;
+				else
+					continue;
+
+				if (op == OP_WRITE && reg == REG_FDRI && len) {
+					_words = _remaining = len;
+					return;
+				}
+
+				if (op == OP_WRITE && reg == REG_FAR && len == 1) {
+					if (!_word(_far))
+						break;
+					count++;
+					continue;
+				}
+
+				/* skip payload of other packets */
+				for (; len && _word(word); len--)
+					count++;
+			}
+
+			throw Format_error();
+		}
+
+	public:
+
+		Frame_stream(Attached_rom_dataspace &rom, size_t max_size)
+		: _bitstream(rom, max_size)
+		{
+			_locate();
+		}
+
+		/* frame address written before the frame data */
+		uint32_t far() const { return _far; }
+
+		size_t frames() const { return _words / FRAME_WORDS; }
+
+		/**
+		 * Read up to 'count' frames into 'dst'
+		 *
+		 * \return  number of frames read
+		 */
+		size_t read_frames(uint32_t *dst, size_t count)
+		{
+			size_t words = min(count * FRAME_WORDS, _remaining);
+			size_t done  = 0;
+
+			for (; done < words; done++)
+				if (!_word(dst[done]))
+					break;
+
+			_remaining -= done;
+			return done / FRAME_WORDS;
+		}
+};
+
+
+class Fpga::Scrubber : Pcap_loader::Job
+{
+	public:
+
+		struct Action : Interface
+		{
+			/* called after each pass and each step that found upsets */
+			virtual void scrub_progress() = 0;
+		};
+
+		struct Stats
+		{
+			unsigned long passes;
+			unsigned long frames;
+			unsigned long upsets;        /* flipped bits found */
+			unsigned long upset_frames;
+			unsigned long repaired_frames;
+			uint64_t      pass_time_us;  /* duration of the last full pass */
+			uint64_t      rate;          /* bytes per second of the last pass */
+		};
+
+	private:
+
+		enum {
+			FRAME_WORDS     = Frame_stream::FRAME_WORDS,
+			FRAME_SIZE      = FRAME_WORDS*4,
+			MAX_STEP_FRAMES = 128,
+			CMD_WORDS       = 64,
+			NOOP            = 0x20000000,
+		};
+
+		Platform::Connection   &_platform;
+		Pcap_loader            &_loader;
+		Action                 &_action;
+
+		size_t   const _max_size;
+		size_t   const _bandwidth;     /* bytes per second */
+		unsigned const _step_frames;
+		bool     const _repair;
+
+		Attached_rom_dataspace                  _rom;
+		Constructible<Attached_rom_dataspace>   _mask_rom { };
+
+		Constructible<Frame_stream> _reference { };
+		Constructible<Frame_stream> _mask      { };
+
+		/* frames of the current step, the readback starts with a pad frame */
+		uint32_t _reference_frames[MAX_STEP_FRAMES*FRAME_WORDS];
+		uint32_t _mask_frames     [MAX_STEP_FRAMES*FRAME_WORDS];
+
+		Platform::Dma_buffer _commands { _platform, 4096, UNCACHED };
+		Platform::Dma_buffer _readback { _platform,
+		                                 align_addr(((MAX_STEP_FRAMES + 1)*FRAME_WORDS + 1)*4, 12),
+		                                 CACHED };
+		Platform::Dma_buffer _rewrite  { _platform,
+		                                 align_addr(((MAX_STEP_FRAMES + 1)*FRAME_WORDS + CMD_WORDS)*4, 12),
+		                                 UNCACHED };
+
+		size_t   _step_count   { 0 };   /* frames of the current step */
+		uint32_t _step_far     { 0 };   /* frame address of the current step */
+		size_t   _pass_frames  { 0 };
+		uint64_t _pass_start   { 0 };
+
+		Stats _stats { 0, 0, 0, 0, 0, 0, 0 };
+
+		Timer::One_shot_timeout<Scrubber> _step_timeout {
+			_loader.timer(), *this, &Scrubber::_handle_step_timeout };
+
+		/*
+		 * Rewrite of the frames of a step
+		 */
+		struct Repair_job : Pcap_loader::Job
+		{
+			Scrubber &_scrubber;
+			size_t    _size { 0 };
+
+			Repair_job(Scrubber &scrubber) : _scrubber(scrubber) { }
+
+			Source load_start() override {
+				return Source { _scrubber._rewrite.dma_addr(), _size }; }
+
+			size_t read_chunk(char *, size_t, size_t) override { return 0; }
+
+			void load_done(bool success) override {
+				_scrubber._repair_done(success); }
+		} _repair_job { *this };
+
+		struct Command_buffer
+		{
+			uint32_t * const base;
+			size_t           pos { 0 };
+
+			void add(uint32_t word) { base[pos++] = word; }
+
+			void sync()
+			{
+				add(0xffffffff);  /* dummy */
+				add(0x000000bb);  /* bus width sync */
+				add(0x11220044);  /* bus width detect */
+				add(0xffffffff);
+				add(Frame_stream::SYNC);
+				add(NOOP);
+			}
+
+			void write(unsigned reg, uint32_t value)
+			{
+				add(0x30000000 | (reg << 13) | 1);
+				add(value);
+			}
+
+			void cmd(uint32_t command) { write(4, command); }
+
+			void noops(unsigned count) { while (count--) add(NOOP); }
+
+			void desync()
+			{
+				noops(1);
+				cmd(0xd);
+				noops(4);
+			}
+
+			size_t size() const { return pos * 4; }
+		};
+
+		enum Command : uint32_t { WCFG = 0x1, RCFG = 0x4, RCRC = 0x7 };
+
+		void _start_pass()
+		{
+			_reference.construct(_rom, _max_size);
+
+			if (_mask_rom.constructed()) {
+				try { _mask.construct(*_mask_rom, 0); }
+				catch (...) {
+					warning("ignoring invalid mask");
+					_mask_rom.destruct();
+				}
+			}
+
+			_step_far    = _reference->far();
+			_pass_frames = 0;
+			_pass_start  = _loader.elapsed_us();
+		}
+
+		/* last frame of the frame data is a pad frame */
+		size_t _total_frames() const {
+			return _reference->frames() ? _reference->frames() - 1 : 0; }
+
+		void _handle_step_timeout(Duration)
+		{
+			if (_pass_frames >= _total_frames()) {
+				_finish_pass();
+				_start_pass();
+			}
+
+			size_t const count = min((size_t)_step_frames, _total_frames() - _pass_frames);
+
+			_step_count = _reference->read_frames(_reference_frames, count);
+			if (_mask.constructed()) {
+				if (_mask->read_frames(_mask_frames, _step_count) != _step_count)
+					_mask.destruct();
+			}
+
+			if (!_step_count) {
+				warning("frame data of bitstream ends prematurely");
+				_pass_frames = _total_frames();
+				_schedule(0);
+				return;
+			}
+
+			_loader.load_bitstream(*this, true);
+		}
+
+		void _finish_pass()
+		{
+			uint64_t const us = _loader.elapsed_us() - _pass_start;
+
+			_stats.passes++;
+			_stats.pass_time_us = us;
+			_stats.rate         = us ? ((uint64_t)(_pass_frames + 1) * FRAME_SIZE * 1000000) / us : 0;
+
+			_action.scrub_progress();
+		}
+
+		/* schedule next step after the time to transfer 'bytes' at the bandwidth */
+		void _schedule(size_t bytes)
+		{
+			uint64_t const us = _bandwidth ? ((uint64_t)bytes * 1000000) / _bandwidth : 0;
+			_step_timeout.schedule(Microseconds { max(us, (uint64_t)1) });
+		}
+
+		/* compare readback of the current step, return number of upset frames */
+		unsigned _compare()
+		{
+			size_t const words = (_step_count + 1) * FRAME_WORDS + 1;
+			cache_invalidate_data((addr_t)_readback.local_addr<char>(), words * 4);
+
+			/* skip the pad frame preceding the frame data */
+			uint32_t const * const readback = _readback.local_addr<uint32_t>() + FRAME_WORDS;
+
+			unsigned frames = 0;
+			for (size_t f = 0; f < _step_count; f++) {
+				unsigned bits = 0;
+				for (size_t w = f*FRAME_WORDS; w < (f + 1)*FRAME_WORDS; w++) {
+					uint32_t diff = readback[w] ^ _reference_frames[w];
+					if (_mask.constructed())
+						diff &= ~_mask_frames[w];
+
+					bits += __builtin_popcount(diff);
+				}
+
+				if (bits) {
+					warning("configuration upset of ", bits, " bits in frame ",
+					        _pass_frames + f, " of step at ", Hex(_step_far));
+					_stats.upsets += bits;
+					frames++;
+				}
+			}
+
+			return frames;
+		}
+
+		/* compose rewrite of all frames of the current step */
+		size_t _compose_rewrite()
+		{
+			Command_buffer buf { _rewrite.local_addr<uint32_t>() };
+
+			buf.sync();
+			buf.cmd(RCRC);
+			buf.noops(2);
+			buf.write(Frame_stream::REG_FAR, _step_far);
+			buf.cmd(WCFG);
+			buf.noops(1);
+
+			/* type-1 write of FDRI followed by type-2 write with the frames and a pad frame */
+			size_t const words = (_step_count + 1) * FRAME_WORDS;
+			buf.add(0x30000000 | (Frame_stream::REG_FDRI << 13));
+			buf.add(0x50000000 | (uint32_t)words);
+			memcpy(buf.base + buf.pos, _reference_frames, _step_count * FRAME_SIZE);
+			buf.pos += _step_count * FRAME_WORDS;
+			memset(buf.base + buf.pos, 0, FRAME_SIZE);
+			buf.pos += FRAME_WORDS;
+
+			buf.desync();
+			return buf.size();
+		}
+
+		void _step_done()
+		{
+			uint32_t const * const readback = _readback.local_addr<uint32_t>();
+
+			unsigned const upset_frames = _compare();
+
+			_stats.frames       += _step_count;
+			_stats.upset_frames += upset_frames;
+
+			/* the frame address following the step is read back last */
+			uint32_t const next_far = readback[(_step_count + 1) * FRAME_WORDS];
+
+			if (upset_frames && _repair) {
+				_repair_job._size = _compose_rewrite();
+				_loader.load_bitstream(_repair_job, true);
+				_step_far = next_far;
+				return;
+			}
+
+			_step_far     = next_far;
+			_pass_frames += _step_count;
+
+			if (upset_frames)
+				_action.scrub_progress();
+
+			_schedule((_step_count + 1) * FRAME_SIZE);
+		}
+
+		void _repair_done(bool success)
+		{
+			if (success)
+				_stats.repaired_frames += _step_count;
+			else
+				error("rewrite of frames failed");
+
+			_pass_frames += _step_count;
+			_action.scrub_progress();
+			_schedule(((_step_count + 1) * FRAME_SIZE) * 2);
+		}
+
+
+		/********************************
+		 ** Pcap_loader::Job interface **
+		 ********************************/
+
+		Source load_start() override
+		{
+			Command_buffer buf { _commands.local_addr<uint32_t>() };
+
+			buf.sync();
+			buf.cmd(RCRC);
+			buf.noops(2);
+			buf.write(Frame_stream::REG_FAR, _step_far);
+			buf.cmd(RCFG);
+
+			/* type-1 read of FDRO followed by type-2 read incl. the pad frame */
+			buf.add(0x28000000 | (3 << 13));
+			buf.add(0x48000000 | (uint32_t)((_step_count + 1) * FRAME_WORDS));
+			buf.noops(32);
+
+			/* read FAR, which points to the frame following the step */
+			buf.add(0x28000000 | (Frame_stream::REG_FAR << 13) | 1);
+			buf.noops(2);
+
+			size_t const commands = buf.size();
+
+			Command_buffer trailer { buf.base + buf.pos };
+			trailer.desync();
+
+			Readback readback { };
+			readback.dma_addr     = _readback.dma_addr();
+			readback.size         = ((_step_count + 1) * FRAME_WORDS + 1) * 4;
+			readback.trailer_addr = _commands.dma_addr() + commands;
+			readback.trailer_size = trailer.size();
+
+			/* no dirty lines must be evicted while the PCAP writes */
+			cache_clean_invalidate_data((addr_t)_readback.local_addr<char>(), readback.size);
+
+			return Source { _commands.dma_addr(), commands, readback };
+		}
+
+		size_t read_chunk(char *, size_t, size_t) override { return 0; }
+
+		void load_done(bool success) override
+		{
+			if (success) {
+				_step_done();
+				return;
+			}
+
+			error("readback of frames at ", Hex(_step_far), " failed, restarting pass");
+			_start_pass();
+			_schedule((_step_count + 1) * FRAME_SIZE);
+		}
+
+	public:
+
+		struct Invalid_bitstream : Exception { };
+
+		using Name = String<128>;
+
+		Scrubber(Env                  &env,
+		         Platform::Connection &platform,
+		         Pcap_loader          &loader,
+		         Action               &action,
+		         Name           const &name,
+		         size_t                max_size,
+		         Xml_node       const &config)
+		:
+			_platform(platform), _loader(loader), _action(action),
+			_max_size(max_size),
+			_bandwidth(config.attribute_value("bandwidth", Number_of_bytes { 1024*1024 })),
+			_step_frames(max(1U, min(config.attribute_value("frames", 64U),
+			                         (unsigned)MAX_STEP_FRAMES))),
+			_repair(config.attribute_value("repair", false)),
+			_rom(env, name.string())
+		{
+			using Mask_name = String<128>;
+			Mask_name const mask = config.attribute_value("mask", Mask_name());
+			if (mask != "")
+				_mask_rom.construct(env, mask.string());
+
+			try {
+				_start_pass();
+			} catch (...) { }
+
+			if (!_reference.constructed() || !_total_frames()) {
+				error("unable to locate frame data of bitstream ", name);
+				throw Invalid_bitstream();
+			}
+
+			if (!_mask_rom.constructed())
+				warning("scrubbing without mask, dynamic frame content is reported as upset");
+
+			_schedule(0);
+		}
+
+		~Scrubber()
+		{
+			_loader.cancel(*this);
+			_loader.cancel(_repair_job);
+		}
+
+		void report(Xml_generator &xml) const
+		{
+			xml.attribute("passes",          _stats.passes);
+			xml.attribute("frames",          _stats.frames);
+			xml.attribute("upsets",          _stats.upsets);
+			xml.attribute("upset_frames",    _stats.upset_frames);
+			xml.attribute("repaired_frames", _stats.repaired_frames);
+			xml.attribute("pass_time_ms",    _stats.pass_time_us / 1000);
+			xml.attribute("rate",            _stats.rate);
+		}
+};
+
+#endif /* _DRIVERS__FPGA__SCRUBBER_H_ */
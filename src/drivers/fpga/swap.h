@@ -0,0 +1,80 @@
+/*
+ * \brief  Byte-swap kernels for bitstream data
+ * \author agent
+ * \date   2026-10-18
+ *
+ * Xilinx .bit files store the configuration words in swapped byte order.
+ * If the compiler targets NEON, the data is swapped in blocks of 64 bytes
+ * by the NEON unit. Otherwise, or for the remaining words, a scalar kernel
+ * is used.
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _DRIVERS__FPGA__SWAP_H_
+#define _DRIVERS__FPGA__SWAP_H_
+
+#include <util/endian.h>
+
+namespace Fpga {
+	using namespace Genode;
+
+	static inline void swap_words_scalar(uint32_t *dst, uint32_t const *src, size_t words)
+	{
+		for (size_t i = 0; i < words; i++)
+			dst[i] = host_to_big_endian(src[i]);
+	}
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+	enum { NEON_SWAP_AVAILABLE = 1 };
+
+	/*
+	 * Swap 16 words per iteration, the remainder is swapped in scalar code
+	 */
+	static inline void swap_words_neon(uint32_t *dst, uint32_t const *src, size_t words)
+	{
+		size_t blocks = words / 16;
+
+		uint32_t       *d = dst;
+		uint32_t const *s = src;
+
+		if (blocks)
+			asm volatile (
+				"1:                            \n"
+				"vld1.8   {d0-d3}, [%[s]]!     \n"
+				"vld1.8   {d4-d7}, [%[s]]!     \n"
+				"vrev32.8 q0, q0               \n"
+				"vrev32.8 q1, q1               \n"
+				"vrev32.8 q2, q2               \n"
+				"vrev32.8 q3, q3               \n"
+				"vst1.8   {d0-d3}, [%[d]]!     \n"
+				"vst1.8   {d4-d7}, [%[d]]!     \n"
+				"subs     %[n], %[n], #1       \n"
+				"bne      1b                   \n"
+				: [s] "+r" (s), [d] "+r" (d), [n] "+r" (blocks)
+				:
+				: "d0", "d1", "d2", "d3", "d4", "d5", "d6", "d7", "cc", "memory");
+
+		swap_words_scalar(d, s, words % 16);
+	}
+
+	static inline void swap_words(uint32_t *dst, uint32_t const *src, size_t words) {
+		swap_words_neon(dst, src, words); }
+
+#else
+
+	enum { NEON_SWAP_AVAILABLE = 0 };
+
+	static inline void swap_words(uint32_t *dst, uint32_t const *src, size_t words) {
+		swap_words_scalar(dst, src, words); }
+
+#endif
+}
+
+#endif /* _DRIVERS__FPGA__SWAP_H_ */
@@ -5,3 +5,6 @@ LIBS     = base
 REQUIRES = arm_v7a
 
 CC_CXX_WARN_STRICT_CONVERSION =
+
+# the Cortex-A9 of the Zynq comes with NEON, used for swapping bitstreams
+CC_OPT += -mfpu=neon
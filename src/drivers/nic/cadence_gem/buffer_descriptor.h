@@ -19,6 +19,8 @@
 #include <platform_session/connection.h>
 #include <platform_session/dma_buffer.h>
 #include <util/mmio.h>
+#include <util/reconstructible.h>
+#include <util/spsc_ring.h>
 
 namespace Cadence_gem {
 	using namespace Genode;
@@ -33,9 +35,8 @@ class Cadence_gem::Buffer_descriptor : protected Platform::Dma_buffer, protected
 		static const size_t BUFFER_DESC_SIZE = 0x08;
 
 	private:
-		size_t _buffer_count;
-		size_t _head_idx { 0 };
-		size_t _tail_idx { 0 };
+		/* head and tail of the descriptor ring */
+		Reconstructible<Spsc_ring_index> _ring;
 
 	protected:
 		typedef struct {
@@ -45,51 +46,44 @@ class Cadence_gem::Buffer_descriptor : protected Platform::Dma_buffer, protected
 
 		descriptor_t* const _descriptors;
 
-		/* set the maximum descriptor index */
+		/* set the maximum descriptor index, the descriptor count must be a power of two */
 		inline
-		void _max_index(size_t max_index) { _buffer_count = max_index+1; };
+		void _max_index(size_t max_index) { _ring.construct((unsigned)max_index+1); };
 
 		/* get the maximum descriptor index */
 		inline
-		unsigned _max_index() { return _buffer_count-1; }
+		unsigned _max_index() { return _ring->capacity()-1; }
 
 		inline
 		void _advance_head()
 		{
-			_head_idx = (_head_idx+1) % _buffer_count;
+			_ring->produce();
 		}
 
 		inline
 		void _advance_tail()
 		{
-			_tail_idx = (_tail_idx+1) % (_buffer_count);
+			_ring->consume();
 		}
 
 		inline
 		descriptor_t& _head()
 		{
-			return _descriptors[_head_idx];
+			return _descriptors[_ring->head_slot()];
 		}
 
 		inline
 		descriptor_t& _tail()
 		{
-			return _descriptors[_tail_idx];
+			return _descriptors[_ring->tail_slot()];
 		}
 
-		size_t _queued() const
-		{
-			if (_head_idx >= _tail_idx)
-				return _head_idx - _tail_idx;
-			else
-				return _head_idx + _buffer_count - _tail_idx;
-		}
+		size_t _queued() const { return _ring->avail(); }
 
-		size_t _head_index() const { return _head_idx; }
-		size_t _tail_index() const { return _tail_idx; }
+		size_t _head_index() const { return _ring->head_slot(); }
+		size_t _tail_index() const { return _ring->tail_slot(); }
 
-		void _reset_head() { _head_idx = 0; }
-		void _reset_tail() { _tail_idx = 0; }
+		void _reset() { _ring->reset(); }
 
 	private:
 
@@ -110,7 +104,7 @@ class Cadence_gem::Buffer_descriptor : protected Platform::Dma_buffer, protected
 		:
 			Platform::Dma_buffer(platform, BUFFER_DESC_SIZE * buffer_count, UNCACHED),
 			Genode::Mmio( reinterpret_cast<addr_t>(local_addr<void>()) ),
-			_buffer_count(buffer_count),
+			_ring((unsigned)buffer_count),
 			_descriptors(local_addr<descriptor_t>())
 		{ }
 };
@@ -60,6 +60,30 @@ class Cadence_gem::Rx_buffer_descriptor : public Buffer_descriptor
 				| Addr::Wrap::bits(i == _max_index());
 		}
 
+		/*
+		 * Reduce the ring to the largest power of two <= count descriptors
+		 * and release the packets of the remaining descriptors
+		 */
+		void _shrink(SOURCE &source, size_t count)
+		{
+			if (!count) {
+				error("Unable to allocate any RX packet");
+				count = 1;
+			}
+
+			size_t const new_count = 1UL << log2(count);
+			for (size_t i = new_count; i < count; i++) {
+				addr_t const dma_addr = Addr::Addr31to2::masked(_descriptors[i].addr);
+				source.release_packet(_dma_pool.packet_descriptor(dma_addr, PACKET_SIZE));
+			}
+
+			/* set new buffer count */
+			_max_index(new_count-1);
+
+			/* set wrap bit */
+			_descriptors[_max_index()].addr |= Addr::Wrap::bits(1);
+		}
+
 		inline bool _head_available()
 		{
 			return Addr::Used::get(_head().addr)
@@ -80,10 +104,7 @@ class Cadence_gem::Rx_buffer_descriptor : public Buffer_descriptor
 					Nic::Packet_descriptor p = source.alloc_packet(PACKET_SIZE);
 					_reset_descriptor(i, _dma_pool.dma_addr(p));
 				} catch (Nic::Session::Rx::Source::Packet_alloc_failed) {
-					/* set new _buffer_count */
-					_max_index(i-1);
-					/* set wrap bit */
-					_descriptors[_max_index()].addr |= Addr::Wrap::bits(1);
+					_shrink(source, i);
 					break;
 				}
 			}
@@ -111,7 +132,7 @@ class Cadence_gem::Rx_buffer_descriptor : public Buffer_descriptor
 				_descriptors[i].status = 0;
 				Addr::Used::set(_descriptors[i].addr, 0);
 			}
-			_reset_head();
+			_reset();
 		}
 
 		bool next_packet()
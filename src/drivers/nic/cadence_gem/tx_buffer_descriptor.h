@@ -93,15 +93,15 @@ class Cadence_gem::Tx_buffer_descriptor : public Buffer_descriptor
 			submit_acks(true);
 
 			/* reset head and tail */
-			_reset_head();
-			_reset_tail();
+			_reset();
 		}
 
 		void submit_acks(bool force=false)
 		{
 			/* the tail marks the descriptor for which we wait to
 			 * be handed over to software */
-			for (size_t i=0; i < _queued(); i++) {
+			size_t const queued = _queued();
+			for (size_t i=0; i < queued; i++) {
 				/* stop if still in use by hardware */
 				if (!Status::Used::get(_tail().status) && !force)
 					break;
@@ -0,0 +1,73 @@
+/*
+ * \brief  CPU clock reporting for Zynq
+ * \author agent
+ * \date   2026-10-18
+ *
+ * The rates of the CPU clocks are part of the 'clocks' report.
+ *
+ * CPU frequency scaling is not supported. The CPU_1x clock of the APB
+ * peripherals and the CPU_3x2x clock of the Cortex-A9 timers are derived
+ * from the CPU clock. The kernel takes the rate of the global timer from
+ * the board-specific constant 'CORTEX_A9_GLOBAL_TIMER_CLK' and does not
+ * follow rate changes. Hence, a '<cpu_freq>' node in the platform driver's
+ * config is refused and the CPU clock stays at its boot-time rate.
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _SRC__DRIVERS__PLATFORM__ZYNQ__CPU_FREQ_H_
+#define _SRC__DRIVERS__PLATFORM__ZYNQ__CPU_FREQ_H_
+
+/* Genode includes */
+#include <util/xml_generator.h>
+
+/* Platform-driver includes */
+#include <clock.h>
+
+namespace Driver { class Cpu_freq; }
+
+
+class Driver::Cpu_freq
+{
+	private:
+
+		Clocks &_clocks;
+
+		unsigned long _rate(char const *name)
+		{
+			unsigned long rate = 0;
+			_clocks.apply(Clock::Name(name), [&] (Clock &clock) {
+				rate = clock.rate().value; });
+			return rate;
+		}
+
+	public:
+
+		Cpu_freq(Clocks &clocks) : _clocks(clocks) { }
+
+		void update(Xml_node const &config)
+		{
+			config.with_optional_sub_node("cpu_freq", [&] (Xml_node const &) {
+				error("CPU frequency scaling refused, the kernel assumes "
+				      "a fixed rate of the global timer"); });
+		}
+
+		void report(Xml_generator &xml)
+		{
+			char const * const clocks[] = {
+				"armpll", "cpu_6or4x", "cpu_3or2x", "cpu_2x", "cpu_1x" };
+
+			for (char const *name : clocks)
+				xml.node("clock", [&] () {
+					xml.attribute("name", name);
+					xml.attribute("rate", _rate(name));
+				});
+		}
+};
+
+#endif /* _SRC__DRIVERS__PLATFORM__ZYNQ__CPU_FREQ_H_ */
@@ -18,7 +18,10 @@
 #include <os/attached_mmio.h>
 #include <util/register_set.h>
 #include <util/misc_math.h>
+#include <util/list.h>
 #include <base/allocator.h>
+#include <base/registry.h>
+#include <os/reporter.h>
 
 /* Platform-driver includes */
 #include <common.h>
@@ -78,9 +81,45 @@ class Driver::Dma_guard : private Attached_mmio,
 	private:
 
 		enum {
-			NUM_SEGMENTS = 10
+			NUM_SEGMENTS = 10,
+
+			/* segments are 4K aligned */
+			MIN_WINDOW_LOG2 = 12
+		};
+
+		/*
+		 * Range of a DMA buffer, the same buffer may be added by
+		 * multiple domains
+		 */
+		struct Buffer_range : List<Buffer_range>::Element
+		{
+			addr_t   start;
+			size_t   size;
+			unsigned count { 1 };
+
+			Buffer_range(addr_t start, size_t size)
+			: start(start), size(size) { }
 		};
 
+		/*
+		 * Naturally aligned power-of-two window covered by a segment
+		 */
+		struct Window
+		{
+			uint64_t base;
+			uint64_t size;
+
+			uint64_t end() const { return base + size; }
+		};
+
+		Env                               & _env;
+		Allocator                         & _alloc;
+		Device::Name                  const _name;
+		List<Buffer_range>                  _ranges    { };
+		Window                              _windows[NUM_SEGMENTS] { };
+		unsigned                            _num_windows { 0 };
+		Constructible<Expanding_reporter>   _reporter  { };
+
 		struct Ctrl : Register<0x0, 32>
 		{
 			struct Enable : Bitfield<0,2>
@@ -105,6 +144,25 @@ class Driver::Dma_guard : private Attached_mmio,
 		void _add_range(Range);
 		void _remove_range(Range);
 
+		bool _pack(bool verbose);
+		void _program_segments();
+		void _apply();
+		void _report();
+
+		static uint32_t _segment_value(Window const &window)
+		{
+			return Segments::Valid::bits(1) |
+			       Segments::Writeable::bits(1) |
+			       Segments::Addr::masked((addr_t)window.base) |
+			       Segments::Size::bits(log2(window.size) - 2);
+		}
+
+		static Window _segment_window(uint32_t value)
+		{
+			return Window { Segments::Addr::masked(value),
+			                1ULL << (Segments::Size::get(value) + 2) };
+		}
+
 		/**
 		 * Iommu interface
 		 */
@@ -134,14 +192,39 @@ class Driver::Dma_guard : private Attached_mmio,
 
 
 		Dma_guard(Env                      & env,
+		          Allocator                & alloc,
 		          Io_mmu_devices           & io_mmu_devices,
 		          Device::Name       const & name,
-		          Device::Io_mem::Range      range)
+		          Device::Io_mem::Range      range,
+		          bool                       report)
 		: Attached_mmio(env, range.start, range.size),
-		  Io_mmu(io_mmu_devices, name)
-		{ };
+		  Io_mmu(io_mmu_devices, name),
+		  _env(env), _alloc(alloc), _name(name)
+		{
+			this->report(report);
+		};
 
-		~Dma_guard() { _destroy_domains(); }
+		~Dma_guard()
+		{
+			_destroy_domains();
+
+			while (Buffer_range * range = _ranges.first()) {
+				_ranges.remove(range);
+				destroy(_alloc, range);
+			}
+		}
+
+		/**
+		 * Enable or disable the report of the segment utilization
+		 */
+		void report(bool enabled)
+		{
+			if (enabled == _reporter.constructed())
+				return;
+
+			_reporter.conditional(enabled, _env, "dma_guard", _name.string());
+			_report();
+		}
 };
 
 
@@ -151,6 +234,10 @@ class Driver::Dma_guard_factory : public Driver::Io_mmu_factory
 
 		Genode::Env  & _env;
 
+		Registry<Registered<Dma_guard>> _guards { };
+
+		bool _report { false };
+
 	public:
 
 		Dma_guard_factory(Genode::Env & env, Common & common)
@@ -165,61 +252,300 @@ class Driver::Dma_guard_factory : public Driver::Io_mmu_factory
 			device.for_each_io_mem([&] (unsigned idx, Range range, Device::Pci_bar, bool)
 			{
 				if (idx == 0)
-					new (alloc) Dma_guard(_env, io_mmu_devices, device.name(), range);
+					new (alloc) Registered<Dma_guard>(_guards, _env, alloc, io_mmu_devices,
+					                                  device.name(), range, _report);
 			});
 		}
+
+		/**
+		 * Enable or disable the utilization reports of all DMA guards
+		 */
+		void report(bool enabled)
+		{
+			_report = enabled;
+			_guards.for_each([&] (Dma_guard & guard) { guard.report(enabled); });
+		}
 };
 
 
 void Driver::Dma_guard::_add_range(Range range)
 {
-	bool found = false;
-
-	/* calculate log2 size */
-	size_t size_log2 = log2(range.size);
-	if ((1U << size_log2) < range.size) size_log2++;
-
-	for (size_t i=0; !found && i < NUM_SEGMENTS; i++) {
-		if (!read<Segments::Valid>(i)) {
-			write<Segments>(
-				Segments::Valid::bits(1) |
-				Segments::Writeable::bits(1) |
-				Segments::Addr::masked(range.start) |
-				Segments::Size::bits(size_log2-2),
-				i);
-			found = true;
+	if (!range.size)
+		return;
+
+	/* keep ranges sorted by start address */
+	Buffer_range * prev = nullptr;
+	for (Buffer_range * r = _ranges.first(); r; r = r->next()) {
+		if (r->start == range.start && r->size == range.size) {
+			r->count++;
+			return;
 		}
+
+		if (r->start > range.start)
+			break;
+
+		prev = r;
+	}
+
+	Buffer_range & added = *new (_alloc) Buffer_range(range.start, range.size);
+	_ranges.insert(&added, prev);
+
+	/* never widen the coverage beyond the buffer ranges */
+	if (!_pack(false)) {
+		error("DMA guard ", _name, ": all segment registers are already in use, "
+		      "range ", Hex_range<addr_t>(range.start, range.size),
+		      " not accessible by DMA");
+		_ranges.remove(&added);
+		destroy(_alloc, &added);
+		return;
 	}
 
-	if (!found)
-		error(__func__, "() all segment registers are already in use");
+	_apply();
 }
 
 
 void Driver::Dma_guard::_remove_range(Range range)
 {
-	bool found = false;
-	uint32_t addr_field = Segments::Addr::get(range.start);
+	for (Buffer_range * r = _ranges.first(); r; r = r->next()) {
+		if (r->start != range.start || r->size != range.size)
+			continue;
 
-	/* find segment for this address and invalidate */
-	size_t i=0;
-	for (; !found && i < NUM_SEGMENTS; i++) {
-		if (read<Segments::Valid>(i) && read<Segments::Addr>(i) == addr_field) {
-			write<Segments::Valid>(0, i);
-			found = true;
+		if (--r->count)
+			return;
+
+		_ranges.remove(r);
+		destroy(_alloc, r);
+		_apply();
+		return;
+	}
+
+	warning(__func__, "() unable to find range ", Hex_range<addr_t>(range.start, range.size));
+}
+
+
+/*
+ * Calculate the windows that cover all buffer ranges
+ *
+ * Overlapping and adjacent ranges are merged into intervals, which are
+ * covered exactly by naturally aligned windows. An interval that needs more
+ * windows than segment registers are left is not covered at all. Returns
+ * false in this case.
+ */
+bool Driver::Dma_guard::_pack(bool verbose)
+{
+	_num_windows = 0;
+
+	uint64_t const page = 1ULL << MIN_WINDOW_LOG2;
+	bool complete = true;
+
+	auto cover_interval = [&] (uint64_t start, uint64_t end)
+	{
+		start = start & ~(page - 1);
+		end   = (end + page - 1) & ~(page - 1);
+
+		Window   windows[NUM_SEGMENTS];
+		unsigned count = 0;
+
+		for (uint64_t base = start; base < end; ) {
+			uint64_t size = page;
+			while (!(base & ((size << 1) - 1)) && base + (size << 1) <= end)
+				size <<= 1;
+
+			if (_num_windows + count == NUM_SEGMENTS) {
+				if (verbose)
+					error("DMA guard ", _name, ": all segment registers are already in use, "
+					      "range ", Hex_range<addr_t>((addr_t)start, (size_t)(end - start)),
+					      " not accessible by DMA");
+				complete = false;
+				return;
+			}
+
+			windows[count++] = Window { base, size };
+			base += size;
 		}
+
+		for (unsigned w = 0; w < count; w++)
+			_windows[_num_windows++] = windows[w];
+	};
+
+	uint64_t start = 0, end = 0;
+	for (Buffer_range const * r = _ranges.first(); r; r = r->next()) {
+		uint64_t const r_end = (uint64_t)r->start + r->size;
+
+		if (end && (r->start & ~(page - 1)) <= ((end + page - 1) & ~(page - 1))) {
+			end = max(end, r_end);
+			continue;
+		}
+
+		if (end)
+			cover_interval(start, end);
+
+		start = r->start;
+		end   = r_end;
 	}
 
-	if (!found)
-		warning(__func__, "() unable to find segment");
+	if (end)
+		cover_interval(start, end);
 
-	/* move remaining segment registers to fill the space of the invalidated segment */
-	for (; i < NUM_SEGMENTS; i++) {
-		if (!read<Segments::Valid>(i))
+	return complete;
+}
+
+
+/*
+ * Write the windows to the segment registers
+ *
+ * Segments that already hold a window are kept. The other windows are
+ * placed in unused segments first. A segment that is no longer needed is
+ * overwritten only if the buffer ranges it covers stay covered by the
+ * other valid segments or by the new window, e.g., if the new window
+ * contains the old one. Hence, the windows replacing a shrinking segment
+ * are in place before the segment is given up, and ranges in use stay
+ * covered while the registers are updated.
+ */
+void Driver::Dma_guard::_program_segments()
+{
+	uint32_t value [NUM_SEGMENTS];
+	bool     keep  [NUM_SEGMENTS] { };
+	bool     placed[NUM_SEGMENTS] { };
+
+	for (unsigned i = 0; i < NUM_SEGMENTS; i++)
+		value[i] = read<Segments>(i);
+
+	auto valid = [&] (unsigned i) { return Segments::Valid::get(value[i]) != 0; };
+
+	for (unsigned i = 0; i < NUM_SEGMENTS; i++) {
+		if (!valid(i))
+			continue;
+
+		for (unsigned w = 0; w < _num_windows && !keep[i]; w++) {
+			if (!placed[w] && _segment_value(_windows[w]) == value[i])
+				placed[w] = keep[i] = true;
+		}
+	}
+
+	/* whether [start, end) is covered by the valid segments except 'skip' or by 'extra' */
+	auto covered = [&] (uint64_t start, uint64_t end, unsigned skip, Window const &extra)
+	{
+		while (start < end) {
+			uint64_t next = start;
+			auto advance = [&] (Window const &w) {
+				if (w.base <= start && start < w.end())
+					next = max(next, w.end()); };
+
+			advance(extra);
+			for (unsigned i = 0; i < NUM_SEGMENTS; i++)
+				if (i != skip && valid(i))
+					advance(_segment_window(value[i]));
+
+			if (next == start)
+				return false;
+
+			start = next;
+		}
+		return true;
+	};
+
+	/* whether overwriting segment 'i' by 'window' keeps all ranges covered */
+	auto replaceable = [&] (unsigned i, Window const &window)
+	{
+		if (!valid(i))
+			return true;
+
+		Window const old = _segment_window(value[i]);
+		for (Buffer_range const * r = _ranges.first(); r; r = r->next()) {
+			uint64_t const start = max((uint64_t)r->start, old.base);
+			uint64_t const end   = min((uint64_t)r->start + r->size, old.end());
+			if (start < end && !covered(start, end, i, window))
+				return false;
+		}
+		return true;
+	};
+
+	auto place = [&] (unsigned w, unsigned i)
+	{
+		value[i] = _segment_value(_windows[w]);
+		write<Segments>(value[i], i);
+		placed[w] = keep[i] = true;
+	};
+
+	for (bool progress = true; progress; ) {
+		progress = false;
+
+		for (unsigned w = 0; w < _num_windows; w++) {
+			if (placed[w])
+				continue;
+
+			unsigned slot = NUM_SEGMENTS;
+			for (unsigned i = 0; i < NUM_SEGMENTS && slot == NUM_SEGMENTS; i++)
+				if (!keep[i] && !valid(i))
+					slot = i;
+			for (unsigned i = 0; i < NUM_SEGMENTS && slot == NUM_SEGMENTS; i++)
+				if (!keep[i] && replaceable(i, _windows[w]))
+					slot = i;
+
+			if (slot == NUM_SEGMENTS)
+				continue;
+
+			place(w, slot);
+			progress = true;
+		}
+	}
+
+	/* windows that could not be placed without a gap in the coverage */
+	for (unsigned w = 0, i = 0; w < _num_windows; w++) {
+		if (placed[w])
+			continue;
+
+		while (i < NUM_SEGMENTS && keep[i]) i++;
+		if (i == NUM_SEGMENTS)
 			break;
 
-		write<Segments>(read<Segments>(i), i-1);
+		warning("DMA guard ", _name, ": ranges of segment ", i,
+		        " are briefly uncovered while reprogramming");
+		place(w, i);
 	}
+
+	/* the ranges are covered by the kept segments only from now on */
+	for (unsigned i = 0; i < NUM_SEGMENTS; i++)
+		if (!keep[i] && valid(i))
+			write<Segments::Valid>(0, i);
+}
+
+
+void Driver::Dma_guard::_apply()
+{
+	_pack(true);
+	_program_segments();
+	_report();
+}
+
+
+void Driver::Dma_guard::_report()
+{
+	if (!_reporter.constructed())
+		return;
+
+	uint64_t covered = 0, used = 0;
+	unsigned ranges  = 0;
+	for (unsigned w = 0; w < _num_windows; w++)
+		covered += _windows[w].size;
+	for (Buffer_range const * r = _ranges.first(); r; r = r->next(), ranges++)
+		used += r->size;
+
+	_reporter->generate([&] (Xml_generator & xml) {
+		xml.attribute("segments", (unsigned)NUM_SEGMENTS);
+		xml.attribute("used",     _num_windows);
+		xml.attribute("ranges",   ranges);
+		xml.attribute("bytes",    used);
+		xml.attribute("covered",  covered);
+
+		for (unsigned w = 0; w < _num_windows; w++) {
+			xml.node("segment", [&] () {
+				xml.attribute("base", String<20>(Hex(_windows[w].base)));
+				xml.attribute("size", String<20>(Hex(_windows[w].size)));
+			});
+		}
+	});
 }
 
 #endif /* _SRC__DRIVERS__PLATFORM__DMA_GUARD_H_ */
@@ -12,9 +12,12 @@
  */
 
 #include <base/component.h>
+#include <os/reporter.h>
 
 #include <slcr.h>
 #include <dma_guard.h>
+#include <cpu_freq.h>
+#include <pl_clocks.h>
 #include <common.h>
 
 namespace Driver { struct Main; };
@@ -37,7 +40,13 @@ struct Driver::Main
 
 	Slcr  _slcr { _env, _common.devices().clocks(), _common.devices().resets(), _ps_clk };
 
+	Cpu_freq  _cpu_freq  { _common.devices().clocks() };
+	Pl_clocks _pl_clocks { _common.devices().clocks(), _slcr };
+
+	Constructible<Expanding_reporter> _clocks_reporter { };
+
 	void _handle_config();
+	void _report_clocks();
 
 	Main(Genode::Env & e)
 	: _env(e)
@@ -54,6 +63,32 @@ void Driver::Main::_handle_config()
 {
 	_config_rom.update();
 	_common.handle_config(_config_rom.xml());
+
+	bool report_dma_guard = false;
+	bool report_clocks    = false;
+	_config_rom.xml().with_optional_sub_node("report", [&] (Xml_node const & node) {
+		report_dma_guard = node.attribute_value("dma_guard", false);
+		report_clocks    = node.attribute_value("clocks",    false); });
+
+	_dma_guard.report(report_dma_guard);
+	_clocks_reporter.conditional(report_clocks, _env, "clocks", "clocks");
+
+	_cpu_freq.update(_config_rom.xml());
+	_pl_clocks.update(_config_rom.xml());
+
+	_report_clocks();
+}
+
+
+void Driver::Main::_report_clocks()
+{
+	if (!_clocks_reporter.constructed())
+		return;
+
+	_clocks_reporter->generate([&] (Xml_generator & xml) {
+		_cpu_freq.report(xml);
+		_pl_clocks.report(xml);
+	});
 }
 
 
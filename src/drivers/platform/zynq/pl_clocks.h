@@ -0,0 +1,119 @@
+/*
+ * \brief  Runtime configuration of the PL clocks
+ * \author agent
+ * \date   2026-10-18
+ *
+ * The rates of the FPGA clocks are applied when a device referring to the
+ * clock is acquired. Beyond that, the rates can be changed at runtime via
+ * the platform driver's config:
+ *
+ * ! <pl_clock name="fpga0" rate="150000000" arm_pll="no"/>
+ *
+ * The ARM PLL is considered as parent of the clock only if 'arm_pll' is
+ * set. The achieved rate may deviate from the requested rate. The
+ * 'clocks' report always shows the actual rate of each clock and the
+ * requested rate while it is in effect. A device acquisition applies the
+ * rate of the devices ROM, which overrides the runtime rate. The runtime
+ * rate is then re-applied with the next config update.
+ */
+
+/*
+ * Copyright (C) 2023 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _SRC__DRIVERS__PLATFORM__ZYNQ__PL_CLOCKS_H_
+#define _SRC__DRIVERS__PLATFORM__ZYNQ__PL_CLOCKS_H_
+
+/* Genode includes */
+#include <util/xml_generator.h>
+
+/* Platform-driver includes */
+#include <clock.h>
+
+/* local includes */
+#include <slcr.h>
+
+namespace Driver { class Pl_clocks; }
+
+
+class Driver::Pl_clocks
+{
+	private:
+
+		enum { NUM_CLOCKS = 4 };
+
+		Clocks &_clocks;
+		Slcr   &_slcr;
+
+		/* rates requested via the config, 0 if not configured */
+		unsigned long _requested[NUM_CLOCKS] { };
+
+		/* rates achieved for the requests */
+		unsigned long _achieved[NUM_CLOCKS] { };
+
+		bool _arm_pll[NUM_CLOCKS] { };
+
+		static Clock::Name _name(unsigned i) {
+			return Clock::Name("fpga", i); }
+
+		unsigned long _rate(unsigned i)
+		{
+			unsigned long rate = 0;
+			_clocks.apply(_name(i), [&] (Clock &clock) {
+				rate = clock.rate().value; });
+			return rate;
+		}
+
+		/* whether the requested rate was overridden, e.g., by a device acquisition */
+		bool _overridden(unsigned i) {
+			return _requested[i] && _rate(i) != _achieved[i]; }
+
+	public:
+
+		Pl_clocks(Clocks &clocks, Slcr &slcr) : _clocks(clocks), _slcr(slcr) { }
+
+		/**
+		 * Apply the rates of the '<pl_clock>' nodes
+		 */
+		void update(Xml_node const &config)
+		{
+			config.for_each_sub_node("pl_clock", [&] (Xml_node const &node) {
+				Clock::Name   const name    = node.attribute_value("name", Clock::Name());
+				unsigned long const rate    = node.attribute_value("rate", 0UL);
+				bool          const arm_pll = node.attribute_value("arm_pll", false);
+
+				for (unsigned i = 0; i < NUM_CLOCKS; i++) {
+					if (name != _name(i) || !rate)
+						continue;
+
+					if (rate == _requested[i] && arm_pll == _arm_pll[i] && !_overridden(i))
+						continue;
+
+					_slcr.fpga_clk_arm_pll(i, arm_pll);
+					_clocks.apply(name, [&] (Clock &clock) {
+						clock.rate(Clock::Rate { rate }); });
+
+					_requested[i] = rate;
+					_achieved[i]  = _rate(i);
+					_arm_pll[i]   = arm_pll;
+				}
+			});
+		}
+
+		void report(Xml_generator &xml)
+		{
+			for (unsigned i = 0; i < NUM_CLOCKS; i++) {
+				xml.node("clock", [&] () {
+					xml.attribute("name", _name(i));
+					xml.attribute("rate", _rate(i));
+					if (_requested[i] && !_overridden(i))
+						xml.attribute("requested", _requested[i]);
+				});
+			}
+		}
+};
+
+#endif /* _SRC__DRIVERS__PLATFORM__ZYNQ__PL_CLOCKS_H_ */
@@ -288,7 +288,7 @@ struct Driver::Slcr : private Attached_mmio
 
 		struct Reg : Register<0, 32>
 		{
-			struct Src_sel  : Bitfield< 4,3> { enum { ARM_PLL = 2, DDR_PLL = 3 }; };
+			struct Src_sel  : Bitfield< 4,3> { enum { IO_PLL = 0, ARM_PLL = 2, DDR_PLL = 3 }; };
 			struct Divisor0 : Bitfield< 8,6> { };
 		};
 
@@ -396,24 +396,83 @@ struct Driver::Slcr : private Attached_mmio
 		: Io_clk(clocks, name, regs, reg_offset)
 		{ }
 
-		static unsigned _find_divisor(unsigned target_div) {
-			unsigned result = 1;
-			unsigned primes[11] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31 };
+		enum { MAX_DIVISOR = 0x3f };
 
-			for (size_t i=0; i < 11; i++) {
-				while (target_div % primes[i] == 0 && (result * primes[i] < 0x3f)) {
-					target_div /= primes[i];
-					result *= primes[i];
+		/*
+		 * The ARM PLL is a candidate parent only if explicitly allowed
+		 * because its rate follows the CPU clock configuration
+		 */
+		bool arm_pll_allowed { false };
+
+		struct Setting
+		{
+			unsigned      src;
+			unsigned      div0;
+			unsigned      div1;
+			unsigned long rate;
+		};
+
+		/*
+		 * Search the parent PLLs and divisor pairs for the rate closest to
+		 * 'target', the ARM PLL is only considered if 'arm_pll_allowed'
+		 *
+		 * The current parent is preferred among equally close settings so
+		 * that other clocks of the PL are not affected by a switch of the
+		 * PLL that stays unused otherwise.
+		 */
+		Setting _best_setting(unsigned long target, unsigned long max_rate)
+		{
+			using Src_sel = Io_clk::Reg::Src_sel;
+
+			struct Parent { unsigned src; char const *name; };
+			Parent const parents[] = {
+				{ Src_sel::IO_PLL,  "iopll"  },
+				{ Src_sel::ARM_PLL, "armpll" },
+				{ Src_sel::DDR_PLL, "ddrpll" } };
+
+			unsigned const sel     = read<Src_sel>();
+			unsigned const current = ((sel == Src_sel::ARM_PLL && arm_pll_allowed) ||
+			                          sel == Src_sel::DDR_PLL)
+			                       ? sel : (unsigned)Src_sel::IO_PLL;
+
+			Setting       best      { current, MAX_DIVISOR, MAX_DIVISOR, 0 };
+			unsigned long best_diff = ~0UL;
+
+			for (Parent const &parent : parents) {
+				if (parent.src == Src_sel::ARM_PLL && !arm_pll_allowed)
+					continue;
+
+				unsigned long parent_rate = 0;
+				_clocks.apply(Name(parent.name), [&] (Clock &clock) {
+					parent_rate = clock.rate().value; });
+
+				for (unsigned div0 = 1; parent_rate && div0 <= MAX_DIVISOR; div0++) {
+					for (unsigned div1 = 1; div1 <= MAX_DIVISOR; div1++) {
+						unsigned long const rate = parent_rate / (div0 * div1);
+						if (rate > max_rate)
+							continue;
+
+						unsigned long const diff = rate > target ? rate - target
+						                                         : target - rate;
+						bool const preferred = diff == best_diff
+						                    && parent.src == current && best.src != current;
+
+						if (diff < best_diff || preferred) {
+							best      = Setting { parent.src, div0, div1, rate };
+							best_diff = diff;
+						}
+
+						/* rates decrease with div1 */
+						if (rate < target)
+							break;
+					}
 				}
-				if (result >= target_div)
-					break;
 			}
 
-			return result;
+			return best;
 		}
 
 		void rate(Rate r) override {
-			unsigned long parent     = _parent_rate().value;
 			unsigned long target     = r.value;
 			unsigned long max_target = 250UL*1000UL*1000UL;
 			if (target > max_target) {
@@ -421,15 +480,18 @@ struct Driver::Slcr : private Attached_mmio
 				target = max_target;
 			}
 
-			unsigned long target_div = parent / target + (parent % target >= target/2);
-			unsigned long div1 = _find_divisor(target_div);
-			unsigned long div0 = target_div / div1;
+			Setting const s = _best_setting(target, max_target);
+			if (!s.rate) {
+				Genode::warning("no parent clock available for PL clock");
+				return;
+			}
 
 			/* first set divisors to max to avoid temporary overclocking */
-			write<Io_clk::Reg::Divisor0>(0x3f);
-			write<Reg::Divisor1>(0x3f);
-			write<Io_clk::Reg::Divisor0>(div0);
-			write<Reg::Divisor1>(div1);
+			write<Io_clk::Reg::Divisor0>(MAX_DIVISOR);
+			write<Reg::Divisor1>(MAX_DIVISOR);
+			write<Io_clk::Reg::Src_sel>(s.src);
+			write<Io_clk::Reg::Divisor0>(s.div0);
+			write<Reg::Divisor1>(s.div1);
 		}
 		Rate rate() const override { return Rate { Io_clk::rate().value / Genode::max(1U, read<Reg::Divisor1>()) }; }
 	};
@@ -446,6 +508,18 @@ struct Driver::Slcr : private Attached_mmio
 
 	Fpga_nreset _fpga_nreset { *this, "fpga_nreset" };
 
+	/**
+	 * Allow the ARM PLL as parent of the PL clock 'fpga<i>'
+	 */
+	void fpga_clk_arm_pll(unsigned i, bool allowed)
+	{
+		Fpga_clk * const fpga_clks[] = {
+			&_fpga0_clk, &_fpga1_clk, &_fpga2_clk, &_fpga3_clk };
+
+		if (i < sizeof(fpga_clks)/sizeof(fpga_clks[0]))
+			fpga_clks[i]->arm_pll_allowed = allowed;
+	}
+
 	Slcr(Genode::Env &env, Clocks &clocks, Resets &resets, Clock &ps_clk)
 	:
 		Attached_mmio(env, 0xf8000000, 0x1000),
@@ -456,4 +530,5 @@ struct Driver::Slcr : private Attached_mmio
 	}
 };
 
+
 #endif /* _SRC__DRIVERS__PLATFORM__ZYNQ__SLCR_H_ */
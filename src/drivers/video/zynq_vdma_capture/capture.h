@@ -0,0 +1,240 @@
+/*
+ * \brief  S2MM frame capture of the AXI VDMA
+ * \author agent
+ * \date   2026-10-18
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _SRC__DRIVERS__VIDEO__ZYNQ_VDMA_CAPTURE__CAPTURE_H_
+#define _SRC__DRIVERS__VIDEO__ZYNQ_VDMA_CAPTURE__CAPTURE_H_
+
+#include <cpu/cache.h>
+#include <drivers/vdma.h>
+
+/* local includes */
+#include <frame_pool.h>
+
+namespace Vdma_capture {
+	using Mode  = Video_capture::Session::Mode;
+	using Frame = Video_capture::Session::Frame;
+	using Stats = Video_capture::Session::Stats;
+
+	class Capture;
+}
+
+
+/*
+ * The VDMA cycles through its frame stores in circular mode. Whenever the
+ * core finished a frame store, the frame is moved to the ready queue and
+ * the frame store is pointed to a free frame of the pool. The new address
+ * takes effect at the next frame boundary, hence captured frames are never
+ * copied.
+ */
+class Vdma_capture::Capture : Noncopyable
+{
+	public:
+
+		struct Init_error : Exception { };
+
+	private:
+
+		using Vdma = ::Vdma::Zynq_Vdma;
+
+		Vdma       &_vdma;
+		Frame_pool &_pool;
+		Mode const  _mode;
+		bool const  _cached;
+
+		unsigned const _stores;
+		unsigned       _store_frame[Vdma::MAX_FRAME_STORES] { };
+		unsigned       _next_store { 0 };
+
+		Stats          _stats    { 0, 0, 0, 0, 0 };
+		unsigned long  _restarts { 0 };
+
+		void _assign(unsigned store, unsigned id)
+		{
+			_store_frame[store] = id;
+			_vdma.s2mm_frame_address(store, _pool.frame(id).buffer.dma_addr());
+		}
+
+		/*
+		 * Hand frame of completed store to the ready queue
+		 *
+		 * \return  true if the frame store was assigned a new frame
+		 */
+		bool _complete(unsigned store)
+		{
+			unsigned long const sequence = ++_stats.captured;
+
+			unsigned replacement = _pool.alloc();
+
+			/* prefer the most recent frame over the oldest unclaimed one */
+			if (replacement == Frame_pool::INVALID) {
+				replacement = _pool.take_ready(Frame_pool::STORE);
+				if (replacement != Frame_pool::INVALID)
+					_stats.dropped++;
+			}
+
+			/* the client holds all spare frames, the store is overwritten */
+			if (replacement == Frame_pool::INVALID) {
+				_stats.dropped++;
+				return false;
+			}
+
+			unsigned const id = _store_frame[store];
+			if (_cached) {
+				Platform::Dma_buffer &buffer = _pool.frame(id).buffer;
+				cache_invalidate_data((addr_t)buffer.local_addr<void>(), buffer.size());
+			}
+
+			_pool.make_ready(id, sequence);
+			_assign(store, replacement);
+			return true;
+		}
+
+		static unsigned _checked_stores(Vdma &vdma, unsigned requested, unsigned frames)
+		{
+			unsigned const available = vdma.s2mm_frame_stores();
+			unsigned const stores    = min(requested, available);
+
+			/* at least one spare frame is needed for the handover */
+			if (stores < 2 || stores >= frames) {
+				error("invalid number of frame stores (", stores, " of ",
+				      available, " with ", frames, " frames)");
+				throw Init_error();
+			}
+
+			return stores;
+		}
+
+	public:
+
+		Capture(Vdma &vdma, Frame_pool &pool, Mode const &mode,
+		        unsigned stores, bool cached)
+		:
+			_vdma(vdma), _pool(pool), _mode(mode), _cached(cached),
+			_stores(_checked_stores(vdma, stores, pool.count()))
+		{ }
+
+		void start(Mmio::Delayer &delayer)
+		{
+			using Cr = Vdma::S2MM_VDMACR;
+
+			if (!_vdma.s2mm_reset(delayer)) {
+				error("VDMA S2MM reset timed out");
+				throw Init_error();
+			}
+
+			_vdma.write<Vdma::S2MM_FRMSTORE>(_stores);
+
+			/* frames held by the client survive a restart */
+			for (unsigned store = 0; store < _stores; store++) {
+				if (_pool.valid(_store_frame[store]) &&
+				    _pool.frame(_store_frame[store]).state == Frame_pool::STORE)
+					_pool.frame(_store_frame[store]).state = Frame_pool::FREE;
+			}
+
+			for (unsigned store = 0; store < _stores; store++) {
+				unsigned id = _pool.alloc();
+				if (id == Frame_pool::INVALID)
+					id = _pool.take_ready(Frame_pool::STORE);
+				if (id == Frame_pool::INVALID) {
+					error("no frames available for frame stores");
+					throw Init_error();
+				}
+				_assign(store, id);
+			}
+			_next_store = 0;
+
+			Cr::access_t cr = 0;
+			Cr::RS::set(cr, 1);
+			Cr::Circular_Park::set(cr, 1);
+			Cr::FrmCnt_IrqEn::set(cr, 1);
+			Cr::Err_IrqEn::set(cr, 1);
+			Cr::Irq_Frame_Count::set(cr, 1);
+			_vdma.write<Cr>(cr);
+
+			_vdma.write<Vdma::S2MM_FRMDLY_STRIDE::Stride>(_mode.stride);
+			_vdma.write<Vdma::S2MM_HSIZE>(_mode.width * _mode.bytes_per_pixel);
+
+			/* writing the vertical size starts the channel */
+			_vdma.write<Vdma::S2MM_VSIZE>(_mode.height);
+		}
+
+		/**
+		 * Handle VDMA interrupt
+		 *
+		 * \return  true if new frames are ready
+		 */
+		bool handle_irq(Mmio::Delayer &delayer)
+		{
+			using Sr = Vdma::S2MM_VDMASR;
+
+			Sr::access_t const sr = _vdma.read<Sr>();
+
+			/* acknowledge interrupts and clear sticky error flags */
+			_vdma.write<Sr>(sr);
+
+			if (Sr::SOFLateErr::get(sr) || Sr::EOLLateErr::get(sr) ||
+			    Sr::SOFEarlyErr::get(sr) || Sr::EOLEarlyErr::get(sr))
+				_stats.errors++;
+
+			/* internal, slave or decode errors halt the channel */
+			if (Sr::DMAIntErr::get(sr) || Sr::DMASlvErr::get(sr) ||
+			    Sr::VDMADecErr::get(sr) || Sr::Halted::get(sr)) {
+				warning("VDMA S2MM halted (status ", Hex(sr), "), restarting");
+				_stats.errors++;
+				_restarts++;
+				start(delayer);
+				return false;
+			}
+
+			/* all stores before the one in progress have been completed */
+			unsigned const current = _vdma.s2mm_current_store() % _stores;
+			unsigned       done    = 0;
+			bool           updated = false;
+			for (; _next_store != current; _next_store = (_next_store + 1) % _stores, done++)
+				updated |= _complete(_next_store);
+
+			/* more than one frame per interrupt means that we were late */
+			if (done > 1)
+				_stats.late += done - 1;
+
+			/* latch the new frame-store addresses at the next frame boundary */
+			if (updated)
+				_vdma.write<Vdma::S2MM_VSIZE>(_mode.height);
+
+			return updated;
+		}
+
+		/**
+		 * Hand oldest ready frame over to the client
+		 */
+		Frame acquire()
+		{
+			unsigned const id = _pool.take_ready(Frame_pool::CLIENT);
+			if (id == Frame_pool::INVALID)
+				return Frame { 0, false, 0 };
+
+			_stats.delivered++;
+			return Frame { id, true, _pool.frame(id).sequence };
+		}
+
+		void release(unsigned id) { _pool.release(id); }
+
+		Mode  mode()  const { return _mode; }
+		Stats stats() const { return _stats; }
+
+		unsigned long restarts() const { return _restarts; }
+
+		unsigned stores() const { return _stores; }
+};
+
+#endif /* _SRC__DRIVERS__VIDEO__ZYNQ_VDMA_CAPTURE__CAPTURE_H_ */
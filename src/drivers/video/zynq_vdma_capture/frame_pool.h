@@ -0,0 +1,140 @@
+/*
+ * \brief  Pool of frame buffers shared between VDMA and client
+ * \author agent
+ * \date   2026-10-18
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _SRC__DRIVERS__VIDEO__ZYNQ_VDMA_CAPTURE__FRAME_POOL_H_
+#define _SRC__DRIVERS__VIDEO__ZYNQ_VDMA_CAPTURE__FRAME_POOL_H_
+
+#include <platform_session/dma_buffer.h>
+#include <util/lazy_array.h>
+#include <util/spsc_ring.h>
+#include <video_capture_session/video_capture_session.h>
+
+namespace Vdma_capture {
+	using namespace Genode;
+
+	class Frame_pool;
+}
+
+
+/*
+ * Each frame is owned by exactly one party at a time: it is either free,
+ * assigned to a frame store of the VDMA, ready for the client, or held by
+ * the client. Ready frames are delivered in the order of their capture.
+ */
+class Vdma_capture::Frame_pool : Noncopyable
+{
+	public:
+
+		enum { MAX_FRAMES = Video_capture::Session::MAX_FRAMES, INVALID = ~0U };
+
+		enum State { FREE, STORE, READY, CLIENT };
+
+		struct Frame
+		{
+			Platform::Dma_buffer buffer;
+			State                state    { FREE };
+			unsigned long        sequence { 0 };
+
+			Frame(Platform::Connection &platform, size_t size, Cache cache)
+			: buffer(platform, size, cache) { }
+		};
+
+	private:
+
+		Lazy_array<Frame, MAX_FRAMES> _frames;
+
+		/* ids of ready frames, oldest first */
+		unsigned        _ready[MAX_FRAMES] { };
+		Spsc_ring_index _ready_index       { MAX_FRAMES };
+
+	public:
+
+		Frame_pool(Platform::Connection &platform, unsigned count,
+		           size_t frame_size, Cache cache)
+		: _frames(count, platform, frame_size, cache)
+		{ }
+
+		unsigned count() const { return _frames.count(); }
+
+		Frame &frame(unsigned id) { return _frames.value(id); }
+
+		bool valid(unsigned id) const { return id < count(); }
+
+		unsigned num(State state)
+		{
+			unsigned result = 0;
+			_frames.for_each([&] (unsigned, Frame const &frame) {
+				if (frame.state == state) result++; });
+			return result;
+		}
+
+		/**
+		 * Take a free frame for assignment to a frame store
+		 *
+		 * \return  id of frame or INVALID
+		 */
+		unsigned alloc()
+		{
+			for (unsigned id = 0; id < count(); id++)
+				if (frame(id).state == FREE) {
+					frame(id).state = STORE;
+					return id;
+				}
+
+			return INVALID;
+		}
+
+		void make_ready(unsigned id, unsigned long sequence)
+		{
+			frame(id).state    = READY;
+			frame(id).sequence = sequence;
+
+			_ready[_ready_index.head_slot()] = id;
+			_ready_index.produce();
+		}
+
+		/**
+		 * Remove oldest ready frame from the ready queue
+		 *
+		 * The frame is assigned to 'state', which is either CLIENT when
+		 * delivering the frame or STORE when recycling it.
+		 *
+		 * \return  id of frame or INVALID
+		 */
+		unsigned take_ready(State state)
+		{
+			if (_ready_index.empty())
+				return INVALID;
+
+			unsigned const id = _ready[_ready_index.tail_slot()];
+			_ready_index.consume();
+
+			frame(id).state = state;
+			return id;
+		}
+
+		void release(unsigned id)
+		{
+			if (valid(id) && frame(id).state == CLIENT)
+				frame(id).state = FREE;
+		}
+
+		/* return all frames held by the client to the pool */
+		void release_all()
+		{
+			for (unsigned id = 0; id < count(); id++)
+				release(id);
+		}
+};
+
+#endif /* _SRC__DRIVERS__VIDEO__ZYNQ_VDMA_CAPTURE__FRAME_POOL_H_ */
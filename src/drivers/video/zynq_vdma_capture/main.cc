@@ -0,0 +1,268 @@
+/*
+ * \brief  Video capture driver for the Xilinx AXI VDMA
+ * \author agent
+ * \date   2026-10-18
+ *
+ * The driver captures the S2MM stream of an AXI VDMA into a pool of frame
+ * buffers and delivers completed frames to a single client by handing over
+ * the ownership of the frame buffers.
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/component.h>
+#include <base/heap.h>
+#include <base/attached_rom_dataspace.h>
+#include <base/session_object.h>
+#include <root/component.h>
+#include <timer_session/connection.h>
+#include <os/reporter.h>
+#include <platform_session/connection.h>
+#include <platform_session/device.h>
+
+/* local includes */
+#include <capture.h>
+
+namespace Vdma_capture {
+	class Session_component;
+	class Root;
+	struct Main;
+}
+
+
+class Vdma_capture::Session_component : public Session_object<Video_capture::Session>
+{
+	private:
+
+		Frame_pool &_pool;
+		Capture    &_capture;
+
+		Signal_context_capability _sigh { };
+
+	public:
+
+		Session_component(Env             &env,
+		                  Resources const &resources,
+		                  Label     const &label,
+		                  Diag      const &diag,
+		                  Frame_pool      &pool,
+		                  Capture         &capture)
+		:
+			Session_object(env.ep(), resources, label, diag),
+			_pool(pool), _capture(capture)
+		{ }
+
+		/* frames still held by the client fall back to the pool */
+		~Session_component() { _pool.release_all(); }
+
+		void notify()
+		{
+			if (_sigh.valid())
+				Signal_transmitter(_sigh).submit();
+		}
+
+
+		/*************************************
+		 ** Video_capture::Session interface **
+		 *************************************/
+
+		Mode mode() override { return _capture.mode(); }
+
+		Dataspace_capability dataspace(unsigned id) override
+		{
+			if (!_pool.valid(id))
+				return Dataspace_capability();
+
+			return _pool.frame(id).buffer.cap();
+		}
+
+		void frame_sigh(Signal_context_capability sigh) override { _sigh = sigh; }
+
+		Frame acquire() override { return _capture.acquire(); }
+
+		void release(unsigned id) override { _capture.release(id); }
+
+		Stats stats() override { return _capture.stats(); }
+};
+
+
+class Vdma_capture::Root : public Root_component<Session_component, Single_client>
+{
+	private:
+
+		Env        &_env;
+		Frame_pool &_pool;
+		Capture    &_capture;
+
+		Session_component *_session { nullptr };
+
+	protected:
+
+		Session_component *_create_session(char const *args) override
+		{
+			_session = new (md_alloc())
+				Session_component(_env,
+				                  session_resources_from_args(args),
+				                  session_label_from_args(args),
+				                  session_diag_from_args(args),
+				                  _pool, _capture);
+			return _session;
+		}
+
+		void _upgrade_session(Session_component *session, const char *args) override
+		{
+			session->upgrade(ram_quota_from_args(args));
+			session->upgrade(cap_quota_from_args(args));
+		}
+
+		void _destroy_session(Session_component *session) override
+		{
+			_session = nullptr;
+			Genode::destroy(md_alloc(), session);
+		}
+
+	public:
+
+		Root(Env &env, Allocator &md_alloc, Frame_pool &pool, Capture &capture)
+		:
+			Root_component<Session_component, Single_client>(env.ep(), md_alloc),
+			_env(env), _pool(pool), _capture(capture)
+		{ }
+
+		void notify()
+		{
+			if (_session)
+				_session->notify();
+		}
+};
+
+
+struct Vdma_capture::Main
+{
+	using Vdma = ::Vdma::Zynq_Vdma;
+	using Name = Platform::Device::Name;
+
+	enum { MAX_FRAMES = Frame_pool::MAX_FRAMES };
+
+	struct Timer_delayer : Timer::Connection, Mmio::Delayer
+	{
+		Timer_delayer(Env &env) : Timer::Connection(env) { }
+
+		void usleep(uint64_t us) override { Timer::Connection::usleep(us); }
+	};
+
+	Env &env;
+
+	Heap                   heap     { env.ram(), env.rm() };
+	Attached_rom_dataspace config   { env, "config" };
+	Timer_delayer          timer    { env };
+	Platform::Connection   platform { env };
+
+	Platform::Device       device   { platform, device_from_xml() };
+	Vdma                   vdma     { device };
+	Platform::Device::Irq  irq      { device };
+
+	Mode const mode  { mode_from_xml() };
+	bool const cache { config.xml().attribute_value("cached", false) };
+
+	Frame_pool pool    { platform, mode.frames, mode.frame_size(),
+	                     cache ? CACHED : UNCACHED };
+	Capture    capture { vdma, pool, mode,
+	                     config.xml().attribute_value("stores", 3U), cache };
+
+	Root root { env, heap, pool, capture };
+
+	Expanding_reporter reporter { env, "capture", "capture" };
+
+	Timer::Periodic_timeout<Main> report_timeout {
+		timer, *this, &Main::handle_report_timeout,
+		Microseconds { 1000UL * config.xml().attribute_value("report_interval_ms", 1000U) } };
+
+	Signal_handler<Main> irq_handler { env.ep(), *this, &Main::handle_irq };
+
+	Name device_from_xml()
+	{
+		Name result = config.xml().attribute_value("device", Name());
+		if (result != "")
+			return result;
+
+		/* use the first VDMA device */
+		platform.update();
+		platform.with_xml([&] (Xml_node &xml) {
+			xml.for_each_sub_node("device", [&] (Xml_node device) {
+				if (result == "" && device.attribute_value("type", Name()) == "axi_vdma")
+					result = device.attribute_value("name", Name()); });
+		});
+
+		return result;
+	}
+
+	Mode mode_from_xml()
+	{
+		Xml_node const xml = config.xml();
+
+		unsigned const width  = xml.attribute_value("width",  640U);
+		unsigned const height = xml.attribute_value("height", 480U);
+		unsigned const bpp    = xml.attribute_value("bytes_per_pixel", 4U);
+		unsigned const stride = xml.attribute_value("stride", width * bpp);
+		unsigned const frames = min(xml.attribute_value("frames", 8U), (unsigned)MAX_FRAMES);
+
+		return Mode { width, height, max(stride, width * bpp), bpp, frames };
+	}
+
+	void handle_irq()
+	{
+		bool const updated = capture.handle_irq(timer);
+		irq.ack();
+
+		if (updated)
+			root.notify();
+	}
+
+	void handle_report_timeout(Duration) { report(); }
+
+	void report()
+	{
+		Stats const stats = capture.stats();
+
+		reporter.generate([&] (Xml_generator &xml) {
+			xml.attribute("width",     mode.width);
+			xml.attribute("height",    mode.height);
+			xml.attribute("frames",    pool.count());
+			xml.attribute("stores",    capture.stores());
+			xml.attribute("captured",  stats.captured);
+			xml.attribute("delivered", stats.delivered);
+			xml.attribute("dropped",   stats.dropped);
+			xml.attribute("late",      stats.late);
+			xml.attribute("errors",    stats.errors);
+			xml.attribute("restarts",  capture.restarts());
+			xml.attribute("ready",     pool.num(Frame_pool::READY));
+			xml.attribute("held",      pool.num(Frame_pool::CLIENT));
+			xml.attribute("free",      pool.num(Frame_pool::FREE));
+		});
+	}
+
+	Main(Env &env) : env(env)
+	{
+		irq.sigh(irq_handler);
+
+		capture.start(timer);
+
+		log("capturing ", mode.width, "x", mode.height, " into ", pool.count(),
+		    " frames (", capture.stores(), " frame stores)");
+
+		env.parent().announce(env.ep().manage(root));
+	}
+};
+
+
+void Component::construct(Genode::Env &env)
+{
+	static Vdma_capture::Main main(env);
+}
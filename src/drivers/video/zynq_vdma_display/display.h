@@ -0,0 +1,227 @@
+/*
+ * \brief  Triple-buffered MM2S scan-out of the AXI VDMA
+ * \author agent
+ * \date   2026-10-18
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _SRC__DRIVERS__VIDEO__ZYNQ_VDMA_DISPLAY__DISPLAY_H_
+#define _SRC__DRIVERS__VIDEO__ZYNQ_VDMA_DISPLAY__DISPLAY_H_
+
+#include <platform_session/dma_buffer.h>
+#include <util/lazy_array.h>
+#include <drivers/vdma.h>
+
+namespace Vdma_display {
+	using namespace Genode;
+
+	class Display;
+}
+
+
+/*
+ * The MM2S channel runs in park mode, i.e., it scans out a single frame
+ * store until the park pointer is changed. Frames are rendered into a
+ * buffer that is neither scanned out nor retiring. On each frame-count
+ * interrupt, the newest rendered frame is parked. The park pointer takes
+ * effect at the next frame boundary, hence the previously parked buffer
+ * is retired for one more frame before it is reused for rendering.
+ */
+class Vdma_display::Display : Noncopyable
+{
+	public:
+
+		enum { NUM_BUFFERS = 3 };
+
+		struct Init_error : Exception { };
+
+		struct Stats
+		{
+			unsigned long frames;     /* frame-count interrupts */
+			unsigned long flips;      /* frames parked for scan-out */
+			unsigned long renders;
+			unsigned long discarded;  /* queued frames replaced before scan-out */
+			unsigned long errors;
+			unsigned long restarts;
+		};
+
+		struct Mode
+		{
+			unsigned width;
+			unsigned height;
+			unsigned stride;           /* bytes per line */
+			unsigned bytes_per_pixel;
+
+			size_t frame_size() const { return (size_t)stride * height; }
+		};
+
+	private:
+
+		using Vdma = ::Vdma::Zynq_Vdma;
+
+		enum State { FREE, QUEUED, SCANOUT, RETIRING };
+
+		struct Buffer
+		{
+			Platform::Dma_buffer dma;
+			State                state { FREE };
+
+			Buffer(Platform::Connection &platform, size_t size)
+			: dma(platform, size, UNCACHED) { }
+		};
+
+		Vdma       &_vdma;
+		Mode const  _mode;
+		bool const  _genlock;
+
+		Lazy_array<Buffer, NUM_BUFFERS> _buffers;
+
+		Stats _stats { 0, 0, 0, 0, 0, 0 };
+
+		Buffer &_buffer(unsigned i) { return _buffers.value(i); }
+
+		unsigned _find(State state)
+		{
+			for (unsigned i = 0; i < NUM_BUFFERS; i++)
+				if (_buffer(i).state == state)
+					return i;
+
+			return NUM_BUFFERS;
+		}
+
+	public:
+
+		Display(Vdma &vdma, Platform::Connection &platform, Mode const &mode,
+		        bool genlock)
+		:
+			_vdma(vdma), _mode(mode), _genlock(genlock),
+			_buffers(NUM_BUFFERS, platform, mode.frame_size())
+		{
+			if (_vdma.read<Vdma::MM2S_FRMSTORE::Num_Frame_Stores>() < NUM_BUFFERS) {
+				error("VDMA MM2S supports less than ", (unsigned)NUM_BUFFERS, " frame stores");
+				throw Init_error();
+			}
+		}
+
+		void start(Mmio::Delayer &delayer)
+		{
+			using Cr = Vdma::MM2S_VDMACR;
+
+			if (!_vdma.mm2s_reset(delayer)) {
+				error("VDMA MM2S reset timed out");
+				throw Init_error();
+			}
+
+			_vdma.write<Vdma::MM2S_FRMSTORE>(NUM_BUFFERS);
+
+			/* keep the frame on screen if there is one */
+			unsigned scanout = _find(SCANOUT);
+			if (scanout == NUM_BUFFERS)
+				scanout = 0;
+
+			for (unsigned i = 0; i < NUM_BUFFERS; i++) {
+				_vdma.mm2s_frame_address(i, _buffer(i).dma.dma_addr());
+				if (_buffer(i).state != QUEUED)
+					_buffer(i).state = FREE;
+			}
+			_buffer(scanout).state = SCANOUT;
+			_vdma.mm2s_park(scanout);
+
+			Cr::access_t cr = 0;
+			Cr::RS::set(cr, 1);
+			Cr::Circular_Park::set(cr, 0);
+			Cr::GenlockEn::set(cr, _genlock);
+			Cr::FrmCnt_IrqEn::set(cr, 1);
+			Cr::Err_IrqEn::set(cr, 1);
+			Cr::Irq_Frame_Count::set(cr, 1);
+			_vdma.write<Cr>(cr);
+
+			_vdma.write<Vdma::MM2S_FRMDLY_STRIDE::Stride>(_mode.stride);
+			_vdma.write<Vdma::MM2S_HSIZE>(_mode.width * _mode.bytes_per_pixel);
+
+			/* writing the vertical size starts the channel */
+			_vdma.write<Vdma::MM2S_VSIZE>(_mode.height);
+		}
+
+		/**
+		 * Render into a buffer that is not visible
+		 *
+		 * A queued frame that has not been parked yet is replaced by the
+		 * new frame, so the newest frame is always shown next. The functor
+		 * is called with the buffer index and the buffer memory.
+		 */
+		template <typename FN>
+		void render(FN const &fn)
+		{
+			unsigned target = _find(QUEUED);
+			if (target < NUM_BUFFERS)
+				_stats.discarded++;
+			else
+				target = _find(FREE);
+
+			/* cannot happen with three buffers */
+			if (target == NUM_BUFFERS)
+				return;
+
+			fn(target, _buffer(target).dma.local_addr<uint8_t>());
+
+			_buffer(target).state = QUEUED;
+			_stats.renders++;
+		}
+
+		/**
+		 * Handle frame-count and error interrupts
+		 */
+		void handle_irq(Mmio::Delayer &delayer)
+		{
+			using Sr = Vdma::MM2S_VDMASR;
+
+			Sr::access_t const sr = _vdma.read<Sr>();
+			_vdma.write<Sr>(sr);
+
+			if (Sr::VDMAIntErr::get(sr) || Sr::VDMASlvErr::get(sr) ||
+			    Sr::VDMADecErr::get(sr) || Sr::Halted::get(sr)) {
+				warning("VDMA MM2S halted (status ", Hex(sr), "), restarting");
+				_stats.errors++;
+				_stats.restarts++;
+				start(delayer);
+				return;
+			}
+
+			if (Sr::SOFEarlyErr::get(sr))
+				_stats.errors++;
+
+			if (!Sr::FrmCnt_Irq::get(sr))
+				return;
+
+			_stats.frames++;
+
+			/* the buffer parked before the last frame is no longer read */
+			unsigned const retiring = _find(RETIRING);
+			if (retiring < NUM_BUFFERS)
+				_buffer(retiring).state = FREE;
+
+			unsigned const queued = _find(QUEUED);
+			if (queued == NUM_BUFFERS)
+				return;
+
+			unsigned const scanout = _find(SCANOUT);
+			if (scanout < NUM_BUFFERS)
+				_buffer(scanout).state = RETIRING;
+
+			_buffer(queued).state = SCANOUT;
+			_vdma.mm2s_park(queued);
+			_stats.flips++;
+		}
+
+		Mode  mode()  const { return _mode; }
+		Stats stats() const { return _stats; }
+};
+
+#endif /* _SRC__DRIVERS__VIDEO__ZYNQ_VDMA_DISPLAY__DISPLAY_H_ */
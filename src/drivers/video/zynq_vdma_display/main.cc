@@ -0,0 +1,190 @@
+/*
+ * \brief  Display driver for the Xilinx AXI VDMA
+ * \author agent
+ * \date   2026-10-18
+ *
+ * The driver obtains the screen content from a capture session and scans it
+ * out via the MM2S channel of an AXI VDMA. Capturing runs at its own pace
+ * whereas page flips happen at frame boundaries only, which rules out
+ * tearing.
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/component.h>
+#include <base/attached_dataspace.h>
+#include <base/attached_rom_dataspace.h>
+#include <capture_session/connection.h>
+#include <timer_session/connection.h>
+#include <os/reporter.h>
+#include <platform_session/connection.h>
+#include <platform_session/device.h>
+
+/* local includes */
+#include <display.h>
+
+namespace Vdma_display { struct Main; }
+
+
+struct Vdma_display::Main
+{
+	using Vdma  = ::Vdma::Zynq_Vdma;
+	using Name  = Platform::Device::Name;
+	using Area  = Capture::Area;
+	using Point = Capture::Point;
+	using Rect  = Capture::Rect;
+	using Pixel = Capture::Pixel;
+
+	struct Timer_delayer : Timer::Connection, Mmio::Delayer
+	{
+		Timer_delayer(Env &env) : Timer::Connection(env) { }
+
+		void usleep(uint64_t us) override { Timer::Connection::usleep(us); }
+	};
+
+	Env &env;
+
+	Attached_rom_dataspace config   { env, "config" };
+	Timer_delayer          timer    { env };
+	Platform::Connection   platform { env };
+
+	Platform::Device       device   { platform, device_from_xml() };
+	Vdma                   vdma     { device };
+	Platform::Device::Irq  irq      { device };
+
+	Display::Mode const mode { mode_from_xml() };
+
+	Display display { vdma, platform, mode,
+	                  config.xml().attribute_value("genlock", false) };
+
+	Area const size { mode.width, mode.height };
+
+	Capture::Connection capture { env };
+
+	Constructible<Attached_dataspace> capture_ds { };
+
+	/* area to be redrawn per buffer since its last rendering */
+	Rect dirty[Display::NUM_BUFFERS] { };
+
+	Expanding_reporter reporter { env, "display", "display" };
+
+	Timer::Periodic_timeout<Main> render_timeout {
+		timer, *this, &Main::handle_render_timeout,
+		Microseconds { 1000UL * config.xml().attribute_value("period_ms", 10U) } };
+
+	Timer::Periodic_timeout<Main> report_timeout {
+		timer, *this, &Main::handle_report_timeout,
+		Microseconds { 1000UL * config.xml().attribute_value("report_interval_ms", 1000U) } };
+
+	Signal_handler<Main> irq_handler { env.ep(), *this, &Main::handle_irq };
+
+	Name device_from_xml()
+	{
+		Name result = config.xml().attribute_value("device", Name());
+		if (result != "")
+			return result;
+
+		/* use the first VDMA device */
+		platform.update();
+		platform.with_xml([&] (Xml_node &xml) {
+			xml.for_each_sub_node("device", [&] (Xml_node device) {
+				if (result == "" && device.attribute_value("type", Name()) == "axi_vdma")
+					result = device.attribute_value("name", Name()); });
+		});
+
+		return result;
+	}
+
+	Display::Mode mode_from_xml()
+	{
+		Xml_node const xml = config.xml();
+
+		unsigned const width  = xml.attribute_value("width",  1280U);
+		unsigned const height = xml.attribute_value("height",  720U);
+		unsigned const bpp    = sizeof(Pixel);
+		unsigned const stride = xml.attribute_value("stride", width * bpp);
+
+		return Display::Mode { width, height, max(stride, width * bpp), bpp };
+	}
+
+	void render(unsigned index, uint8_t *dst)
+	{
+		Rect const rect = dirty[index];
+		dirty[index]    = Rect();
+
+		if (!rect.valid())
+			return;
+
+		Pixel const *src = capture_ds->local_addr<Pixel const>();
+
+		size_t const line_bytes = rect.w() * sizeof(Pixel);
+		for (int y = rect.y1(); y <= rect.y2(); y++)
+			memcpy(dst + y*mode.stride + rect.x1()*sizeof(Pixel),
+			       src + y*size.w() + rect.x1(), line_bytes);
+	}
+
+	void handle_render_timeout(Duration)
+	{
+		bool changed = false;
+
+		capture.capture_at(Point(0, 0)).for_each_rect([&] (Rect const &rect) {
+			for (Rect &d : dirty)
+				d = d.valid() ? Rect::compound(d, rect) : rect;
+			changed = true;
+		});
+
+		if (changed)
+			display.render([&] (unsigned index, uint8_t *dst) {
+				render(index, dst); });
+	}
+
+	void handle_irq()
+	{
+		display.handle_irq(timer);
+		irq.ack();
+	}
+
+	void handle_report_timeout(Duration)
+	{
+		Display::Stats const stats = display.stats();
+
+		reporter.generate([&] (Xml_generator &xml) {
+			xml.attribute("width",     mode.width);
+			xml.attribute("height",    mode.height);
+			xml.attribute("frames",    stats.frames);
+			xml.attribute("flips",     stats.flips);
+			xml.attribute("renders",   stats.renders);
+			xml.attribute("discarded", stats.discarded);
+			xml.attribute("errors",    stats.errors);
+			xml.attribute("restarts",  stats.restarts);
+		});
+	}
+
+	Main(Env &env) : env(env)
+	{
+		capture.buffer(size);
+		capture_ds.construct(env.rm(), capture.dataspace());
+
+		/* all buffers are drawn completely at first */
+		for (Rect &d : dirty)
+			d = Rect(Point(0, 0), size);
+
+		irq.sigh(irq_handler);
+		display.start(timer);
+
+		log("display ", mode.width, "x", mode.height,
+		    " with ", (unsigned)Display::NUM_BUFFERS, " frame buffers");
+	}
+};
+
+
+void Component::construct(Genode::Env &env)
+{
+	static Vdma_display::Main main(env);
+}
@@ -0,0 +1,274 @@
+/*
+ * \brief  axicdma wrapper
+ * \author agent
+ * \date   2026-10-18
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _XILINX_AXICDMA_H_
+#define _XILINX_AXICDMA_H_
+
+/* Genode includes */
+#include <base/signal.h>
+#include <util/reconstructible.h>
+#include <util/spsc_ring.h>
+#include <platform_session/connection.h>
+#include <platform_session/device.h>
+#include <platform_session/dma_buffer.h>
+
+/* Xilinx includes */
+#include <xaxicdma.h>
+#include <xil_cache.h>
+
+namespace Xilinx {
+	using namespace Genode;
+
+	using Device            = Platform::Device;
+
+	class Axicdma;
+}
+
+
+class Xilinx::Axicdma
+{
+	public:
+
+		/*
+		 * The device may operate in different modes.
+		 *  - SIMPLE programs one transfer at a time and starts the next
+		 *    queued transfer from the completion interrupt
+		 *  - SG hands queued copies as descriptor chains to the
+		 *    Scatter/Gather engine, which processes them back to back
+		 */
+		enum Mode   { SIMPLE, SG };
+		enum Result { OKAY, DEVICE_ERROR, CONFIG_ERROR, QUEUE_FULL };
+
+		enum { QUEUE_SIZE = 32, BD_COUNT = 64 };
+
+		struct Init_error : Exception { };
+
+		/*
+		 * Copy request in terms of DMA addresses
+		 */
+		struct Copy
+		{
+			unsigned long id  { 0 };
+			addr_t        dst { 0 };
+			addr_t        src { 0 };
+			size_t        len { 0 };
+		};
+
+		struct Stats
+		{
+			unsigned long copies { 0 };
+			uint64_t      bytes  { 0 };
+			unsigned long irqs   { 0 };
+			unsigned long failed { 0 };
+			unsigned long errors { 0 };
+			unsigned long resets { 0 };
+		};
+
+		struct Handler_base : Interface, Genode::Noncopyable
+		{
+			virtual void handle_copy_complete(Copy const &, bool success) = 0;
+		};
+
+		template <typename T>
+		struct Copy_complete_handler : Handler_base
+		{
+			T &_obj;
+			void (T::*_member) (Copy const &, bool);
+
+			Copy_complete_handler(T &obj, void (T::*member)(Copy const &, bool))
+			: _obj(obj), _member(member) { }
+
+			void handle_copy_complete(Copy const &copy, bool success) override
+			{
+				(_obj.*_member)(copy, success);
+			}
+		};
+
+	private:
+
+		Env                                &_env;
+
+		/* platform connection, either owned or provided by the client */
+		Constructible<Platform::Connection> _own_platform { };
+		Platform::Connection               &_platform;
+
+		Device::Name const                  _name;
+		Device                              _device;
+		Mode                                _mode;
+
+		/* device has a single I/O mem and a single IRQ */
+		Device::Mmio          _mmio   { _device };
+		Device::Irq           _irq    { _device, Device::Irq::Index { 0 } };
+
+		XAxiCdma              _xaxicdma { };
+
+		/* descriptor memory for SG mode */
+		Constructible<Platform::Dma_buffer> _bd_buffer { };
+
+		Handler_base         *_complete_handler { nullptr };
+
+		/* queued copies, copies are completed in order */
+		struct Entry
+		{
+			Copy          copy   { };
+			unsigned long seq    { 0 };
+			unsigned      bds    { 0 };      /* descriptors used in SG mode */
+			bool          notify { false };  /* report to complete handler */
+		};
+
+		Entry            _queue[QUEUE_SIZE] { };
+		Spsc_ring_index  _queue_index { QUEUE_SIZE };
+
+		unsigned long    _seq          { 0 };  /* sequence number of last queued copy */
+		unsigned         _submitted    { 0 };  /* copies handed to the device */
+		size_t           _offset       { 0 };  /* progress of head copy in SIMPLE mode */
+		size_t           _in_flight    { 0 };  /* length of current SIMPLE transfer */
+		unsigned         _bds_done     { 0 };  /* completed descriptors of head copies */
+		unsigned         _done         { 0 };  /* transfers reported by the driver */
+		bool             _error        { false };
+		bool             _recovering   { false };
+
+		/* sequence number and result of a blocking copy */
+		unsigned long    _wait_seq     { 0 };
+		bool             _wait_done    { false };
+		bool             _wait_success { false };
+
+		unsigned         _reset_timeout { 10000 };
+		Stats            _stats         { };
+
+		/* irq handler must be an io signal handler to allow blocking semantics of copy() */
+		Io_signal_handler<Axicdma> _irq_handler {
+			_env.ep(), *this, &Axicdma::_handle_irq };
+
+		/* helper methods */
+		Platform::Connection &_construct_platform(Env &env)
+		{
+			_own_platform.construct(env);
+			return *_own_platform;
+		}
+
+		static void _callback(void *, u32, int *);
+
+		void             _setup();
+		XAxiCdma_Config  _config();
+		Result           _init();
+		Result           _create_bd_ring();
+		Result           _queue_copy(Platform::Dma_buffer const &, size_t,
+		                             Platform::Dma_buffer const &, size_t,
+		                             size_t, unsigned long, bool);
+		bool             _reset();
+		void             _recover();
+		size_t           _max_transfer() const;
+		Entry           &_entry(unsigned n) { return _queue[_queue_index.tail_slot(n)]; }
+		void             _complete(bool success);
+		void             _start_simple();
+		void             _start_sg();
+		void             _kick();
+		void             _handle_irq();
+
+		/* Noncopyable */
+		Axicdma(Axicdma const &) = delete;
+		void operator=(Axicdma const &) = delete;
+
+	public:
+
+		/**
+		 * Constructor using an own platform connection and the first
+		 * 'axi_cdma' device
+		 */
+		Axicdma(Env &env, Mode mode)
+		: _env(env),
+		  _platform(_construct_platform(env)),
+		  _name(device_name(_platform, 0)),
+		  _device(_platform, _name),
+		  _mode(mode)
+		{
+			_setup();
+		}
+
+		/**
+		 * Constructor
+		 *
+		 * \param platform  platform connection shared with other users
+		 * \param name      name of the 'axi_cdma' device to acquire
+		 */
+		Axicdma(Env &env, Platform::Connection &platform, Mode mode,
+		        Device::Name const &name)
+		: _env(env),
+		  _platform(platform),
+		  _name(name),
+		  _device(_platform, _name),
+		  _mode(mode)
+		{
+			_setup();
+		}
+
+		/**
+		 * Return name of the 'axi_cdma' device with the given index
+		 *
+		 * \throw Init_error  no such device
+		 */
+		static Device::Name device_name(Platform::Connection &, unsigned index);
+
+		Device::Name const &name() const { return _name; }
+
+		Mode mode() const { return _mode; }
+
+		/*
+		 * Copy 'len' bytes between DMA buffers and block until the copy
+		 * completed (memcpy-like interface)
+		 *
+		 * Like memcpy, the regions must not overlap. For CACHED buffers,
+		 * the caller is responsible for syncing the source for the device
+		 * before and the destination for the CPU after the copy.
+		 */
+		Result copy(Platform::Dma_buffer &dst, size_t dst_offset,
+		            Platform::Dma_buffer const &src, size_t src_offset, size_t len);
+
+		Result copy(Platform::Dma_buffer &dst, Platform::Dma_buffer const &src, size_t len) {
+			return copy(dst, 0, src, 0, len); }
+
+		/*
+		 * Queue an asynchronous copy
+		 *
+		 * Completion is reported to the complete handler with the given 'id'.
+		 * Returns QUEUE_FULL if QUEUE_SIZE copies are outstanding.
+		 */
+		Result submit(Platform::Dma_buffer &dst, size_t dst_offset,
+		              Platform::Dma_buffer const &src, size_t src_offset,
+		              size_t len, unsigned long id) {
+			return _queue_copy(dst, dst_offset, src, src_offset, len, id, true); }
+
+		/* number of outstanding copies */
+		unsigned pending() const { return _queue_index.avail(); }
+
+		bool idle() const { return !pending(); }
+
+		void complete_handler(Handler_base &handler) {
+			_complete_handler = &handler; }
+
+		Stats const &stats() const { return _stats; }
+
+		/*
+		 * Cache maintenance for CACHED DMA buffers
+		 */
+		static void sync_for_device(Platform::Dma_buffer &buf, size_t offset, size_t len) {
+			Xil_DCacheFlushRange((INTPTR)(buf.local_addr<char>() + offset), (u32)len); }
+
+		static void sync_for_cpu(Platform::Dma_buffer &buf, size_t offset, size_t len) {
+			Xil_DCacheInvalidateRange((INTPTR)(buf.local_addr<char>() + offset), (u32)len); }
+
+		Platform::Connection &platform() { return _platform; }
+};
+
+#endif /* _XILINX_AXICDMA_H_ */
@@ -20,9 +20,11 @@
 #include <platform_session/connection.h>
 #include <platform_session/device.h>
 #include <platform_session/dma_buffer.h>
+#include <platform_session/dma_arena.h>
 
 /* Xilinx includes */
 #include <xaxidma.h>
+#include <xil_cache.h>
 
 namespace Xilinx {
 	using namespace Genode;
@@ -40,13 +42,111 @@ class Xilinx::Axidma
 		 * The device may operate in different modes.
 		 *  - SIMPLE and NORMAL refer to Direct Register Mode (single transfers)
 		 *    without/with interrupt support
-		 *  - SG refers to Scatter/Gather mode, which allows queueing
+		 *  - SG refers to Scatter/Gather mode, which allows queueing up to
+		 *    BD_COUNT transfers per channel and coalescing their completion
+		 *    interrupts
 		 */
-		enum Mode   { NORMAL, SIMPLE, SG };
-		enum Result { OKAY, DEVICE_ERROR, CONFIG_ERROR };
+		enum Mode      { NORMAL, SIMPLE, SG };
+		enum Result    { OKAY, DEVICE_ERROR, CONFIG_ERROR };
+		enum Direction { DMA_TO_DEVICE, DEVICE_TO_DMA };
+
+		enum { BD_COUNT = 64 };
+
+		/*
+		 * Completion modes for NORMAL mode
+		 *  - IRQ waits for the completion interrupt
+		 *  - POLL busy-polls the channel status until completion
+		 *  - HYBRID busy-polls for a limited number of iterations (poll
+		 *    window) and falls back to the interrupt if the window expires
+		 */
+		enum Completion { IRQ, POLL, HYBRID };
 
 		struct Init_error : Exception { };
 
+		/*
+		 * Error recovery policy
+		 *
+		 * On a DMA error, the device is reset and the reset is polled for
+		 * at most 'reset_timeout' iterations. If 'resubmit' is set, the
+		 * transfers that were outstanding at the time of the error are
+		 * restarted up to 'max_retries' times in a row.
+		 */
+		struct Recovery_config
+		{
+			bool     resubmit      { false };
+			unsigned max_retries   { 3 };
+			unsigned reset_timeout { 10000 };
+		};
+
+		/*
+		 * Interrupt coalescing in SG mode
+		 *
+		 * The completion interrupt is raised after 'threshold' completed
+		 * transfers or when the delay timer expires. The delay is given in
+		 * multiples of 125 cycles of the SG clock, 0 disables the timer.
+		 * Without the timer, completions below the threshold are not
+		 * signalled until further transfers complete.
+		 *
+		 * The parameters can be set via the 'irq_threshold' and 'irq_delay'
+		 * device properties.
+		 */
+		struct Coalescing
+		{
+			unsigned threshold { 1 };
+			unsigned delay     { 0 };
+		};
+
+		/*
+		 * Interrupt counters
+		 */
+		struct Irq_stats
+		{
+			unsigned long irqs        { 0 };
+			unsigned long completions { 0 };
+		};
+
+		/*
+		 * Counters of transfers that completed during busy-polling and of
+		 * transfers for which the poll window expired
+		 */
+		struct Poll_stats
+		{
+			unsigned long polled    { 0 };
+			unsigned long fallbacks { 0 };
+		};
+
+		/*
+		 * Error counters
+		 */
+		struct Error_stats
+		{
+			unsigned long errors         { 0 };
+			unsigned long internal       { 0 };
+			unsigned long slave          { 0 };
+			unsigned long decode         { 0 };
+			unsigned long resets         { 0 };
+			unsigned long reset_timeouts { 0 };
+			unsigned long resubmissions  { 0 };
+			unsigned long dropped        { 0 };
+		};
+
+		/*
+		 * Error completion of a transfer that was outstanding when an error
+		 * occurred
+		 */
+		struct Transfer_error
+		{
+			Direction direction;
+			addr_t    dma_addr;
+			size_t    len;
+			uint32_t  status;       /* channel status register */
+			bool      resubmitted;  /* transfer has been restarted */
+
+			bool internal() const { return status & XAXIDMA_ERR_INTERNAL_MASK; }
+			bool slave()    const { return status & XAXIDMA_ERR_SLAVE_MASK; }
+			bool decode()   const { return status & XAXIDMA_ERR_DECODE_MASK; }
+		};
+
 		struct Handler_base : Interface, Genode::Noncopyable
 		{
 			virtual void handle_transfer_complete() = 0;
@@ -67,13 +167,37 @@ class Xilinx::Axidma
 			}
 		};
 
+		struct Error_handler_base : Interface, Genode::Noncopyable
+		{
+			virtual void handle_transfer_error(Transfer_error const &) = 0;
+		};
+
+		template <typename T>
+		struct Transfer_error_handler : Error_handler_base
+		{
+			T &_obj;
+			void (T::*_member) (Transfer_error const &);
+
+			Transfer_error_handler(T &obj, void (T::*member)(Transfer_error const &))
+			: _obj(obj), _member(member) { }
+
+			void handle_transfer_error(Transfer_error const &error) override
+			{
+				(_obj.*_member)(error);
+			}
+		};
+
 	private:
 
-		Env                  &_env;
-		Platform::Connection  _platform;
-		Device::Type          _type { "axi_dma" };
-		Device                _device;
-		Mode                  _mode;
+		Env                                &_env;
+
+		/* platform connection, either owned or provided by the client */
+		Constructible<Platform::Connection> _own_platform { };
+		Platform::Connection               &_platform;
+
+		Device::Name const                  _name;
+		Device                              _device;
+		Mode                                _mode;
 
 		/* device has a single I/O mem */
 		Device::Mmio          _mmio   { _device };
@@ -84,17 +208,64 @@ class Xilinx::Axidma
 		Constructible<Device::Irq> _rx_irq { };
 		Constructible<Device::Irq> _tx_irq { };
 
-		Handler_base *_rx_complete_handler { nullptr };
-		Handler_base *_tx_complete_handler { nullptr };
+		Handler_base       *_rx_complete_handler { nullptr };
+		Handler_base       *_tx_complete_handler { nullptr };
+		Error_handler_base *_error_handler       { nullptr };
+
+		/* descriptor memory of the tx and rx ring in SG mode */
+		Constructible<Platform::Dma_buffer> _bd_buffer { };
+
+		/* bookkeeping of outstanding transfers for error recovery */
+		struct Job
+		{
+			addr_t dma_addr { 0 };
+			size_t len      { 0 };
+			bool   pending  { false };
+		};
+
+		Job             _tx_job    { };
+		Job             _rx_job    { };
+		unsigned        _retries   { 0 };
+		Recovery_config _recovery  { };
+		Error_stats     _stats     { };
+
+		Coalescing      _coalescing { };
+		Irq_stats       _irq_stats  { };
+
+		/* length of the last completed rx transfer in SG mode */
+		size_t          _rx_transferred { 0 };
+
+		Completion      _completion  { Completion::IRQ };
+		unsigned        _poll_window { 0 };
+		Poll_stats      _poll_stats  { };
 
 		/* irq handler must be an io signal handler to allow blocking semantics of simple_transfer() */
 		Io_signal_handler<Axidma> _irq_handler {
 			_env.ep(), *this, &Axidma::_handle_irq };
 
 		/* helper methods */
+		Platform::Connection &_construct_platform(Env &env)
+		{
+			_own_platform.construct(env);
+			return *_own_platform;
+		}
+
+		void           _setup();
 		XAxiDma_Config _config();
 		Result         _init();
+		void           _setup_interrupts();
+		Result         _create_bd_rings();
+		void           _apply_coalescing();
+		XAxiDma_BdRing &_ring(Direction);
+		void           _complete_bds(Direction);
+		void           _recover_bds(uint32_t, uint32_t);
+		bool           _reset();
+		void           _recover(uint32_t, uint32_t);
+		Result         _submit(Direction, addr_t, size_t);
+		Result         _submit_bd(Direction, addr_t, size_t);
+		Result         _start_transfer(Direction, addr_t, size_t);
 		void           _handle_irq();
+		bool           _poll(unsigned);
 
 		/* Noncopyable */
 		Axidma(Axidma const &) = delete;
@@ -102,33 +273,77 @@ class Xilinx::Axidma
 
 	public:
 
+		/**
+		 * Constructor using an own platform connection and the first
+		 * 'axi_dma' device
+		 */
 		Axidma(Env &env, Mode mode)
 		: _env(env),
-		  _platform(env),
-		  _device(_platform, _type),
+		  _platform(_construct_platform(env)),
+		  _name(device_name(_platform, 0)),
+		  _device(_platform, _name),
 		  _mode(mode)
 		{
-			if (_mode == Mode::SG) {
-				error("Scatter/Gather mode not supported");
-				throw Init_error();
-			}
+			_setup();
+		}
 
-			if (_mode == Mode::NORMAL) {
-				_rx_irq.construct(_device, Device::Irq::Index { 0 });
-				_tx_irq.construct(_device, Device::Irq::Index { 1 });
+		/**
+		 * Constructor
+		 *
+		 * \param platform  platform connection shared with other users
+		 * \param name      name of the 'axi_dma' device to acquire
+		 */
+		Axidma(Env &env, Platform::Connection &platform, Mode mode,
+		       Device::Name const &name)
+		: _env(env),
+		  _platform(platform),
+		  _name(name),
+		  _device(_platform, _name),
+		  _mode(mode)
+		{
+			_setup();
+		}
 
-				_rx_irq->sigh(_irq_handler);
-				_tx_irq->sigh(_irq_handler);
-			}
+		/**
+		 * Constructor
+		 *
+		 * \param platform  platform connection shared with other users
+		 * \param index     index of the 'axi_dma' device to acquire
+		 */
+		Axidma(Env &env, Platform::Connection &platform, Mode mode,
+		       unsigned index)
+		: Axidma(env, platform, mode, device_name(platform, index))
+		{ }
+
+		/**
+		 * Return name of the 'axi_dma' device with the given index
+		 *
+		 * \throw Init_error  no such device
+		 */
+		static Device::Name device_name(Platform::Connection &, unsigned index);
 
-			Result result = _init();
-			if (result != Result::OKAY)
-				throw Init_error();
-		}
+		/**
+		 * Return number of 'axi_dma' devices available at the platform session
+		 */
+		static unsigned device_count(Platform::Connection &);
+
+		Device::Name const &name() const { return _name; }
 
 		/* Initiate a single blocking transfer from a DMA buffer to device and vice versa. */
+		Result simple_transfer(Platform::Dma_buffer const &src, size_t src_len,
+		                       Platform::Dma_buffer const &dst, size_t dst_len) {
+			return simple_transfer(src, src_len, dst, dst_len, _completion); }
+
+		/* Blocking transfer with the given completion mode */
 		Result simple_transfer(Platform::Dma_buffer const &, size_t,
-		                       Platform::Dma_buffer const &, size_t);
+		                       Platform::Dma_buffer const &, size_t,
+		                       Completion);
+
+		/*
+		 * In SG mode, up to BD_COUNT transfers per direction may be
+		 * outstanding. The complete handler is called for each completed
+		 * transfer, possibly several times per interrupt.
+		 */
 
 		/* Initiate a transfer from memory to device */
 		Result start_tx_transfer(Platform::Dma_buffer const &, size_t);
@@ -136,15 +351,94 @@ class Xilinx::Axidma
 		/* Initiate a transfer from device to memory */
 		Result start_rx_transfer(Platform::Dma_buffer const &, size_t);
 
+		/* Initiate a transfer from device to memory at an offset within the buffer */
+		Result start_rx_transfer(Platform::Dma_buffer const &, size_t offset, size_t len);
+
+		/* Transfers of buffers placed in a 'Platform::Dma_arena' */
+		Result start_tx_transfer(Platform::Dma_arena::Buffer const &buf, size_t len) {
+			return _start_transfer(DMA_TO_DEVICE, buf.dma_addr(), len); }
+
+		Result start_rx_transfer(Platform::Dma_arena::Buffer const &buf, size_t len) {
+			return _start_transfer(DEVICE_TO_DMA, buf.dma_addr(), len); }
+
+		/*
+		 * Number of bytes written by the last completed rx transfer
+		 *
+		 * The value is smaller than the requested length if the stream
+		 * signalled the end of a packet (TLAST) before the buffer was filled.
+		 */
+		size_t rx_transferred() const;
+
+		/* Maximum length of a single transfer as configured in the core */
+		size_t max_transfer_size() const;
+
 		bool tx_transfer_complete();
 		bool rx_transfer_complete();
 
+		/*
+		 * Cache maintenance for CACHED DMA buffers
+		 *
+		 * Unless the device accesses memory via the coherent ACP port, a
+		 * cached buffer must be synced for the device before starting a
+		 * transfer and synced for the CPU after an rx transfer completed.
+		 */
+		template <typename BUFFER>
+		static void sync_for_device(BUFFER &buf, size_t len) {
+			Xil_DCacheFlushRange((INTPTR)buf.template local_addr<void>(), (u32)len); }
+
+		template <typename BUFFER>
+		static void sync_for_cpu(BUFFER &buf, size_t len) {
+			Xil_DCacheInvalidateRange((INTPTR)buf.template local_addr<void>(), (u32)len); }
+
+		template <typename BUFFER>
+		static void sync_for_cpu(BUFFER &buf, size_t offset, size_t len) {
+			Xil_DCacheInvalidateRange((INTPTR)(buf.template local_addr<char>() + offset), (u32)len); }
+
 		void rx_complete_handler(Handler_base &handler) {
 			_rx_complete_handler = &handler; }
 
 		void tx_complete_handler(Handler_base &handler) {
 			_tx_complete_handler = &handler; }
 
+		void error_handler(Error_handler_base &handler) {
+			_error_handler = &handler; }
+
+		void recovery_config(Recovery_config const &config) {
+			_recovery = config; }
+
+		Error_stats const &error_stats() const { return _stats; }
+
+		/*
+		 * Set interrupt coalescing parameters, effective in SG mode only
+		 */
+		void coalescing(Coalescing const &);
+
+		Coalescing const &coalescing() const { return _coalescing; }
+
+		Irq_stats const &irq_stats() const { return _irq_stats; }
+
+		/*
+		 * Set default completion mode and poll window (in iterations)
+		 */
+		void completion(Completion mode, unsigned poll_window)
+		{
+			_completion  = mode;
+			_poll_window = poll_window;
+		}
+
+		/*
+		 * Busy-poll for the completion of the outstanding transfers
+		 *
+		 * Polling is performed according to the default completion mode.
+		 * Returns true if all outstanding transfers completed within the
+		 * poll window. In this case, the completion interrupt is
+		 * acknowledged and the complete handlers are NOT called, i.e. the
+		 * caller is responsible for processing the completion.
+		 */
+		bool poll_completion();
+
+		Poll_stats const &poll_stats() const { return _poll_stats; }
+
 		Platform::Connection &platform() { return _platform; }
 };
 
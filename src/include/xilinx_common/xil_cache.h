@@ -1,5 +1,5 @@
 /*
- * \brief  Cache maintenance dummies for xilinx_common
+ * \brief  Cache maintenance for xilinx_common
  * \author Johannes Schlatow
  * \date   2022-11-11
  */
@@ -14,5 +14,20 @@
 #ifndef XIL_CACHE_H
 #define XIL_CACHE_H
 
+#include <xil_types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* clean and invalidate data-cache lines of the given range */
+void Xil_DCacheFlushRange(INTPTR adr, u32 len);
+
+/* invalidate data-cache lines of the given range */
+void Xil_DCacheInvalidateRange(INTPTR adr, u32 len);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif /* XIL_CACHE_H */
@@ -0,0 +1,418 @@
+/*
+ * \brief  axicdma wrapper
+ * \author agent
+ * \date   2026-10-18
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#include <xilinx_axicdma.h>
+
+static constexpr char const *AXICDMA_TYPE = "axi_cdma";
+
+
+template <typename FN>
+static void for_each_axicdma_device(Platform::Connection &platform, FN const &fn)
+{
+	using Name = Genode::String<64>;
+
+	platform.update();
+	platform.with_xml([&] (Genode::Xml_node & xml) {
+		xml.for_each_sub_node("device", [&] (Genode::Xml_node device) {
+			if (device.attribute_value("type", Name { }) == AXICDMA_TYPE)
+				fn(device);
+		});
+	});
+}
+
+
+Xilinx::Device::Name Xilinx::Axicdma::device_name(Platform::Connection &platform, unsigned index)
+{
+	Device::Name result { };
+	unsigned     i = 0;
+
+	for_each_axicdma_device(platform, [&] (Xml_node const &device) {
+		if (i++ == index)
+			result = device.attribute_value("name", Device::Name { });
+	});
+
+	if (result == "") {
+		error("No ", AXICDMA_TYPE, " device with index ", index, " available");
+		throw Init_error();
+	}
+
+	return result;
+}
+
+
+void Xilinx::Axicdma::_setup()
+{
+	_irq.sigh(_irq_handler);
+
+	Result result = _init();
+	if (result != Result::OKAY)
+		throw Init_error();
+}
+
+
+XAxiCdma_Config Xilinx::Axicdma::_config()
+{
+	XAxiCdma_Config result { };
+
+	result.BaseAddress = (UINTPTR)_mmio.local_addr<unsigned>();
+
+	using Name = String<64>;
+
+	for_each_axicdma_device(_platform, [&] (Xml_node const &device) {
+		if (device.attribute_value("name", Device::Name { }) != _name)
+			return;
+
+		device.for_each_sub_node("property", [&] (Xml_node par) {
+			Name name  = par.attribute_value("name", Name());
+			int  value = par.attribute_value("value", 0);
+
+			if (name == "XPAR_AXI_CDMA__INCLUDE_DRE")              result.HasDRE    = value;
+			else if (name == "XPAR_AXI_CDMA__USE_DATAMOVER_LITE")  result.IsLite    = value;
+			else if (name == "XPAR_AXI_CDMA__M_AXI_DATA_WIDTH")    result.DataWidth = value;
+			else if (name == "XPAR_AXI_CDMA__M_AXI_MAX_BURST_LEN") result.BurstLen  = value;
+			else if (name == "XPAR_AXI_CDMA__ADDR_WIDTH")          result.AddrWidth = value;
+		});
+	});
+
+	if (result.DataWidth == 0 || result.BurstLen == 0)
+		warning("Invalid CDMA configuration parameters (missing data width or burst length)");
+
+	return result;
+}
+
+
+Xilinx::Axicdma::Result Xilinx::Axicdma::_init()
+{
+	XAxiCdma_Config cfg = _config();
+
+	int status = XAxiCdma_CfgInitialize(&_xaxicdma, &cfg, cfg.BaseAddress);
+	if (status != XST_SUCCESS) {
+		error("Initialization failed: ", status);
+		return Result::CONFIG_ERROR;
+	}
+
+	if (_mode == Mode::SG) {
+		if (!XAxiCdma_HasSg(&_xaxicdma)) {
+			error("Device has no Scatter/Gather engine");
+			return Result::CONFIG_ERROR;
+		}
+
+		Result result = _create_bd_ring();
+		if (result != Result::OKAY)
+			return result;
+	}
+
+	XAxiCdma_IntrEnable(&_xaxicdma, XAXICDMA_XR_IRQ_ALL_MASK);
+
+	return Result::OKAY;
+}
+
+
+Xilinx::Axicdma::Result Xilinx::Axicdma::_create_bd_ring()
+{
+	enum { BD_ALIGN = XAXICDMA_BD_MINIMUM_ALIGNMENT };
+
+	if (!_bd_buffer.constructed())
+		_bd_buffer.construct(_platform, BD_COUNT * BD_ALIGN, UNCACHED);
+
+	Genode::memset(_bd_buffer->local_addr<void>(), 0, BD_COUNT * BD_ALIGN);
+
+	int status = XAxiCdma_BdRingCreate(&_xaxicdma, _bd_buffer->dma_addr(),
+	                                   (UINTPTR)_bd_buffer->local_addr<void>(),
+	                                   BD_ALIGN, BD_COUNT);
+	if (status != XST_SUCCESS) {
+		error("XAxiCdma_BdRingCreate() failed: ", status);
+		return Result::CONFIG_ERROR;
+	}
+
+	return Result::OKAY;
+}
+
+
+size_t Xilinx::Axicdma::_max_transfer() const
+{
+	/* keep transfers page aligned for cores without data realignment engine */
+	return max((size_t)_xaxicdma.MaxTransLen & ~0xfffUL, (size_t)0x1000);
+}
+
+
+bool Xilinx::Axicdma::_reset()
+{
+	_stats.resets++;
+
+	XAxiCdma_Reset(&_xaxicdma);
+
+	bool done = false;
+	for (unsigned timeout = _reset_timeout; !done && timeout; timeout--)
+		done = XAxiCdma_ResetIsDone(&_xaxicdma);
+
+	if (!done) {
+		error("DMA reset timed out");
+		return false;
+	}
+
+	/* the descriptor ring is stale after a reset */
+	if (_mode == Mode::SG && _create_bd_ring() != Result::OKAY)
+		return false;
+
+	/* reset clears the interrupt enable bits */
+	XAxiCdma_IntrEnable(&_xaxicdma, XAXICDMA_XR_IRQ_ALL_MASK);
+
+	return true;
+}
+
+
+void Xilinx::Axicdma::_recover()
+{
+	_stats.errors++;
+
+	error("DMA error (status ", Hex(XAxiCdma_GetError(&_xaxicdma)), "), "
+	      "resetting device for recovery");
+
+	_reset();
+
+	/*
+	 * All copies handed to the device are lost. New copies queued by the
+	 * complete handler must not be started before the lost ones are
+	 * removed from the queue.
+	 */
+	_recovering = true;
+
+	unsigned const lost = _submitted;
+	_offset    = 0;
+	_in_flight = 0;
+	_bds_done  = 0;
+	for (unsigned i = 0; i < lost; i++)
+		_complete(false);
+
+	_recovering = false;
+	_kick();
+}
+
+
+void Xilinx::Axicdma::_callback(void *ref, u32 irq_mask, int *)
+{
+	Axicdma &cdma = *static_cast<Axicdma *>(ref);
+
+	if (irq_mask & XAXICDMA_XR_IRQ_ERROR_MASK)
+		cdma._error = true;
+	else
+		cdma._done++;
+}
+
+
+void Xilinx::Axicdma::_complete(bool success)
+{
+	Entry const entry = _entry(0);
+	_queue_index.consume();
+
+	if (_submitted)
+		_submitted--;
+
+	if (success) {
+		_stats.copies++;
+		_stats.bytes += entry.copy.len;
+	} else
+		_stats.failed++;
+
+	if (entry.seq == _wait_seq) {
+		_wait_done    = true;
+		_wait_success = success;
+	}
+
+	if (entry.notify && _complete_handler)
+		_complete_handler->handle_copy_complete(entry.copy, success);
+}
+
+
+void Xilinx::Axicdma::_start_simple()
+{
+	while (!_in_flight && !_queue_index.empty()) {
+		Copy const  &copy = _entry(0).copy;
+		size_t const len  = min(copy.len - _offset, _max_transfer());
+
+		int status = XAxiCdma_SimpleTransfer(&_xaxicdma,
+		                                     copy.src + _offset,
+		                                     copy.dst + _offset,
+		                                     (int)len, _callback, this);
+		if (status == XST_SUCCESS) {
+			_in_flight = len;
+			_submitted = 1;
+			return;
+		}
+
+		error("XAxiCdma_SimpleTransfer() failed: ", status);
+		_offset    = 0;
+		_submitted = 1;
+		_complete(false);
+	}
+}
+
+
+void Xilinx::Axicdma::_start_sg()
+{
+	size_t const max_len = _max_transfer();
+
+	while (_submitted < _queue_index.avail()) {
+		Entry         &entry = _entry(_submitted);
+		unsigned const bds   = (unsigned)((entry.copy.len + max_len - 1) / max_len);
+
+		if ((int)bds > XAxiCdma_BdRingGetFreeCnt(&_xaxicdma))
+			return;
+
+		XAxiCdma_Bd *first = nullptr;
+		if (XAxiCdma_BdRingAlloc(&_xaxicdma, bds, &first) != XST_SUCCESS)
+			return;
+
+		XAxiCdma_Bd *bd = first;
+		for (size_t offset = 0; offset < entry.copy.len; offset += max_len) {
+			XAxiCdma_BdSetSrcBufAddr(bd, entry.copy.src + offset);
+			XAxiCdma_BdSetDstBufAddr(bd, entry.copy.dst + offset);
+			XAxiCdma_BdSetLength(bd, (int)min(entry.copy.len - offset, max_len),
+			                     _xaxicdma.MaxTransLen);
+			bd = XAxiCdma_BdRingNext(&_xaxicdma, bd);
+		}
+
+		int status = XAxiCdma_BdRingToHw(&_xaxicdma, bds, first, _callback, this);
+		if (status == XST_SUCCESS) {
+			entry.bds = bds;
+			_submitted++;
+			continue;
+		}
+
+		error("XAxiCdma_BdRingToHw() failed: ", status);
+		XAxiCdma_BdRingUnAlloc(&_xaxicdma, bds, first);
+
+		/* retry on next completion unless nothing is in flight */
+		if (_submitted)
+			return;
+
+		_submitted = 1;
+		_complete(false);
+	}
+}
+
+
+void Xilinx::Axicdma::_kick()
+{
+	if (_recovering)
+		return;
+
+	if (_mode == Mode::SG)
+		_start_sg();
+	else
+		_start_simple();
+}
+
+
+void Xilinx::Axicdma::_handle_irq()
+{
+	_irq.ack();
+
+	_stats.irqs++;
+
+	/* the driver acknowledges the interrupt and calls '_callback' */
+	_done  = 0;
+	_error = false;
+	XAxiCdma_IntrHandler(&_xaxicdma);
+
+	if (_error) {
+		_recover();
+		return;
+	}
+
+	if (_mode == Mode::SG) {
+		/* recycle descriptors and complete all copies whose chain is done */
+		XAxiCdma_Bd *bd = nullptr;
+		int const n = XAxiCdma_BdRingFromHw(&_xaxicdma, XAXICDMA_ALL_BDS, &bd);
+		if (n > 0) {
+			XAxiCdma_BdRingFree(&_xaxicdma, n, bd);
+			_bds_done += n;
+		}
+
+		while (_submitted && _bds_done >= _entry(0).bds) {
+			_bds_done -= _entry(0).bds;
+			_complete(true);
+		}
+	}
+	else if (_done && _in_flight) {
+		_offset   += _in_flight;
+		_in_flight = 0;
+
+		if (_offset == _entry(0).copy.len) {
+			_offset = 0;
+			_complete(true);
+		} else
+			_submitted = 0;
+	}
+
+	_kick();
+}
+
+
+Xilinx::Axicdma::Result Xilinx::Axicdma::_queue_copy(Platform::Dma_buffer const &dst, size_t dst_offset,
+                                                     Platform::Dma_buffer const &src, size_t src_offset,
+                                                     size_t len, unsigned long id, bool notify)
+{
+	if (!len || dst_offset + len > dst.size() || src_offset + len > src.size()) {
+		error("copy exceeds DMA buffer");
+		return Result::CONFIG_ERROR;
+	}
+
+	if (_mode == Mode::SG && (len + _max_transfer() - 1) / _max_transfer() > BD_COUNT) {
+		error("copy of ", len, " bytes exceeds descriptor ring");
+		return Result::CONFIG_ERROR;
+	}
+
+	if (_queue_index.full())
+		return Result::QUEUE_FULL;
+
+	Entry &entry = _queue[_queue_index.head_slot()];
+	entry.copy   = Copy { id, dst.dma_addr() + dst_offset, src.dma_addr() + src_offset, len };
+	entry.seq    = ++_seq;
+	entry.bds    = 0;
+	entry.notify = notify;
+	_queue_index.produce();
+
+	_kick();
+
+	return Result::OKAY;
+}
+
+
+Xilinx::Axicdma::Result Xilinx::Axicdma::copy(Platform::Dma_buffer &dst, size_t dst_offset,
+                                              Platform::Dma_buffer const &src, size_t src_offset,
+                                              size_t len)
+{
+	/* the copy may already fail while being queued */
+	_wait_seq  = _seq + 1;
+	_wait_done = false;
+
+	Result const result = _queue_copy(dst, dst_offset, src, src_offset, len, 0, false);
+	if (result != Result::OKAY) {
+		_wait_seq = 0;
+		return result;
+	}
+
+	while (!_wait_done)
+		_env.ep().wait_and_dispatch_one_io_signal();
+
+	_wait_seq = 0;
+
+	if (!_wait_success) {
+		error("Xilinx::Axicdma::copy: failed");
+		return Result::DEVICE_ERROR;
+	}
+
+	return Result::OKAY;
+}
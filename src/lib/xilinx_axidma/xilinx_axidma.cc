@@ -13,6 +13,67 @@
 
 #include <xilinx_axidma.h>
 
+static constexpr char const *AXIDMA_TYPE = "axi_dma";
+
+
+template <typename FN>
+static void for_each_axidma_device(Platform::Connection &platform, FN const &fn)
+{
+	using Name = Genode::String<64>;
+
+	platform.update();
+	platform.with_xml([&] (Genode::Xml_node & xml) {
+		xml.for_each_sub_node("device", [&] (Genode::Xml_node device) {
+			if (device.attribute_value("type", Name { }) == AXIDMA_TYPE)
+				fn(device);
+		});
+	});
+}
+
+
+Xilinx::Device::Name Xilinx::Axidma::device_name(Platform::Connection &platform, unsigned index)
+{
+	Device::Name result { };
+	unsigned     i = 0;
+
+	for_each_axidma_device(platform, [&] (Xml_node const &device) {
+		if (i++ == index)
+			result = device.attribute_value("name", Device::Name { });
+	});
+
+	if (result == "") {
+		error("No ", AXIDMA_TYPE, " device with index ", index, " available");
+		throw Init_error();
+	}
+
+	return result;
+}
+
+
+unsigned Xilinx::Axidma::device_count(Platform::Connection &platform)
+{
+	unsigned count = 0;
+	for_each_axidma_device(platform, [&] (Xml_node const &) { count++; });
+	return count;
+}
+
+
+void Xilinx::Axidma::_setup()
+{
+	if (_mode != Mode::SIMPLE) {
+		_rx_irq.construct(_device, Device::Irq::Index { 0 });
+		_tx_irq.construct(_device, Device::Irq::Index { 1 });
+
+		_rx_irq->sigh(_irq_handler);
+		_tx_irq->sigh(_irq_handler);
+	}
+
+	Result result = _init();
+	if (result != Result::OKAY)
+		throw Init_error();
+}
+
+
 XAxiDma_Config Xilinx::Axidma::_config()
 {
 	XAxiDma_Config result { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
@@ -22,32 +83,31 @@ XAxiDma_Config Xilinx::Axidma::_config()
 
 	using Name = String<64>;
 
-	_platform.update();
-	_platform.with_xml([&] (Xml_node & xml) {
-		xml.for_each_sub_node("device", [&] (Xml_node device) {
-			if (device.attribute_value("type", Name { }) != _type.name)
-				return;
-
-			device.for_each_sub_node("property", [&] (Xml_node par) {
-				Name name  = par.attribute_value("name", Name());
-				int  value = par.attribute_value("value", 0);
-
-				if (name == "XPAR_AXI_DMA__SG_INCLUDE_STSCNTRL_STRM")   result.HasStsCntrlStrm = value;
-				else if (name == "XPAR_AXI_DMA__INCLUDE_MM2S")          result.HasMm2S         = value;
-				else if (name == "XPAR_AXI_DMA__INCLUDE_MM2S_DRE")      result.HasMm2SDRE      = value;
-				else if (name == "XPAR_AXI_DMA__M_AXI_MM2S_DATA_WIDTH") result.Mm2SDataWidth   = value;
-				else if (name == "XPAR_AXI_DMA__INCLUDE_S2MM")          result.HasS2Mm         = value;
-				else if (name == "XPAR_AXI_DMA__INCLUDE_S2MM_DRE")      result.HasMm2SDRE      = value;
-				else if (name == "XPAR_AXI_DMA__M_AXI_S2MM_DATA_WIDTH") result.S2MmDataWidth   = value;
-				else if (name == "XPAR_AXI_DMA__INCLUDE_SG")            result.HasSg           = value;
-				else if (name == "XPAR_AXI_DMA__NUM_MM2S_CHANNELS")     result.Mm2sNumChannels = value;
-				else if (name == "XPAR_AXI_DMA__NUM_S2MM_CHANNELS")     result.S2MmNumChannels = value;
-				else if (name == "XPAR_AXI_DMA__MM2S_BURST_SIZE")       result.Mm2SBurstSize   = value;
-				else if (name == "XPAR_AXI_DMA__S2MM_BURST_SIZE")       result.S2MmBurstSize   = value;
-				else if (name == "XPAR_AXI_DMA__MICRO_DMA")             result.MicroDmaMode    = value;
-				else if (name == "XPAR_AXI_DMA__ADDR_WIDTH")            result.AddrWidth       = value;
-				else if (name == "XPAR_AXI_DMA__SG_LENGTH_WIDTH")       result.SgLengthWidth   = value;
-			});
+	for_each_axidma_device(_platform, [&] (Xml_node const &device) {
+		if (device.attribute_value("name", Device::Name { }) != _name)
+			return;
+
+		device.for_each_sub_node("property", [&] (Xml_node par) {
+			Name name  = par.attribute_value("name", Name());
+			int  value = par.attribute_value("value", 0);
+
+			if (name == "XPAR_AXI_DMA__SG_INCLUDE_STSCNTRL_STRM")   result.HasStsCntrlStrm = value;
+			else if (name == "XPAR_AXI_DMA__INCLUDE_MM2S")          result.HasMm2S         = value;
+			else if (name == "XPAR_AXI_DMA__INCLUDE_MM2S_DRE")      result.HasMm2SDRE      = value;
+			else if (name == "XPAR_AXI_DMA__M_AXI_MM2S_DATA_WIDTH") result.Mm2SDataWidth   = value;
+			else if (name == "XPAR_AXI_DMA__INCLUDE_S2MM")          result.HasS2Mm         = value;
+			else if (name == "XPAR_AXI_DMA__INCLUDE_S2MM_DRE")      result.HasMm2SDRE      = value;
+			else if (name == "XPAR_AXI_DMA__M_AXI_S2MM_DATA_WIDTH") result.S2MmDataWidth   = value;
+			else if (name == "XPAR_AXI_DMA__INCLUDE_SG")            result.HasSg           = value;
+			else if (name == "XPAR_AXI_DMA__NUM_MM2S_CHANNELS")     result.Mm2sNumChannels = value;
+			else if (name == "XPAR_AXI_DMA__NUM_S2MM_CHANNELS")     result.S2MmNumChannels = value;
+			else if (name == "XPAR_AXI_DMA__MM2S_BURST_SIZE")       result.Mm2SBurstSize   = value;
+			else if (name == "XPAR_AXI_DMA__S2MM_BURST_SIZE")       result.S2MmBurstSize   = value;
+			else if (name == "XPAR_AXI_DMA__MICRO_DMA")             result.MicroDmaMode    = value;
+			else if (name == "XPAR_AXI_DMA__ADDR_WIDTH")            result.AddrWidth       = value;
+			else if (name == "XPAR_AXI_DMA__SG_LENGTH_WIDTH")       result.SgLengthWidth   = value;
+			else if (name == "irq_threshold")                       _coalescing.threshold  = value;
+			else if (name == "irq_delay")                           _coalescing.delay      = value;
 		});
 	});
 
@@ -77,6 +137,28 @@ Xilinx::Axidma::Result Xilinx::Axidma::_init()
 		return Result::CONFIG_ERROR;
 	}
 
+	if (_mode == Mode::SG) {
+		if (!XAxiDma_HasSg(&_xaxidma)) {
+			error("Device has no Scatter/Gather engine");
+			return Result::CONFIG_ERROR;
+		}
+
+		Result result = _create_bd_rings();
+		if (result != Result::OKAY)
+			return result;
+	}
+
+	/* sanitise coalescing parameters from device properties */
+	coalescing(_coalescing);
+
+	_setup_interrupts();
+
+	return Result::OKAY;
+}
+
+
+void Xilinx::Axidma::_setup_interrupts()
+{
 	switch (_mode) {
 		case Mode::SIMPLE:
 			/* disable interrupts */
@@ -91,19 +173,335 @@ Xilinx::Axidma::Result Xilinx::Axidma::_init()
 			                              XAXIDMA_DEVICE_TO_DMA);
 			XAxiDma_IntrEnable(&_xaxidma, XAXIDMA_IRQ_ALL_MASK,
 			                              XAXIDMA_DMA_TO_DEVICE);
+			break;
 		case Mode::SG:
+			if (_xaxidma.HasS2Mm)
+				XAxiDma_BdRingIntEnable(&_ring(DEVICE_TO_DMA), XAXIDMA_IRQ_ALL_MASK);
+			if (_xaxidma.HasMm2S)
+				XAxiDma_BdRingIntEnable(&_ring(DMA_TO_DEVICE), XAXIDMA_IRQ_ALL_MASK);
+			_apply_coalescing();
 			break;
 	}
+}
+
+
+XAxiDma_BdRing &Xilinx::Axidma::_ring(Direction dir)
+{
+	return dir == DMA_TO_DEVICE ? *XAxiDma_GetTxRing(&_xaxidma)
+	                            : *XAxiDma_GetRxRing(&_xaxidma);
+}
+
+
+Xilinx::Axidma::Result Xilinx::Axidma::_create_bd_rings()
+{
+	enum {
+		BD_ALIGN  = XAXIDMA_BD_MINIMUM_ALIGNMENT,
+		RING_SIZE = BD_COUNT * BD_ALIGN
+	};
+
+	if (!_bd_buffer.constructed())
+		_bd_buffer.construct(_platform, 2 * RING_SIZE, UNCACHED);
+
+	Genode::memset(_bd_buffer->local_addr<void>(), 0, 2 * RING_SIZE);
+
+	auto create = [&] (Direction dir, size_t offset)
+	{
+		XAxiDma_BdRing &ring = _ring(dir);
+
+		int status = XAxiDma_BdRingCreate(&ring, _bd_buffer->dma_addr() + offset,
+		                                  (UINTPTR)_bd_buffer->local_addr<char>() + offset,
+		                                  BD_ALIGN, BD_COUNT);
+		if (status != XST_SUCCESS) {
+			error("XAxiDma_BdRingCreate() failed: ", status);
+			return false;
+		}
+
+		XAxiDma_Bd bd_template;
+		XAxiDma_BdClear(&bd_template);
+		status = XAxiDma_BdRingClone(&ring, &bd_template);
+		if (status != XST_SUCCESS) {
+			error("XAxiDma_BdRingClone() failed: ", status);
+			return false;
+		}
+
+		status = XAxiDma_BdRingStart(&ring);
+		if (status != XST_SUCCESS) {
+			error("XAxiDma_BdRingStart() failed: ", status);
+			return false;
+		}
+
+		return true;
+	};
+
+	if (_xaxidma.HasMm2S && !create(DMA_TO_DEVICE, 0))
+		return Result::CONFIG_ERROR;
+
+	if (_xaxidma.HasS2Mm && !create(DEVICE_TO_DMA, RING_SIZE))
+		return Result::CONFIG_ERROR;
 
 	return Result::OKAY;
 }
 
 
+void Xilinx::Axidma::_apply_coalescing()
+{
+	if (_mode != Mode::SG)
+		return;
+
+	auto apply = [&] (Direction dir) {
+		int status = XAxiDma_BdRingSetCoalesce(&_ring(dir), _coalescing.threshold,
+		                                       _coalescing.delay);
+		if (status != XST_SUCCESS)
+			warning("XAxiDma_BdRingSetCoalesce() failed: ", status);
+	};
+
+	if (_xaxidma.HasMm2S) apply(DMA_TO_DEVICE);
+	if (_xaxidma.HasS2Mm) apply(DEVICE_TO_DMA);
+}
+
+
+void Xilinx::Axidma::coalescing(Coalescing const &c)
+{
+	enum { MAX = 0xff };
+
+	_coalescing = Coalescing { min(max(c.threshold, 1U), (unsigned)MAX),
+	                           min(c.delay, (unsigned)MAX) };
+
+	if (_mode != Mode::SG && (_coalescing.threshold > 1 || _coalescing.delay))
+		warning("IRQ coalescing is only effective in Scatter/Gather mode");
+
+	if (_mode == Mode::SG && _coalescing.threshold > 1 && !_coalescing.delay)
+		warning("IRQ coalescing without delay timer, completions may be "
+		        "held back until ", _coalescing.threshold, " transfers completed");
+
+	_apply_coalescing();
+}
+
+
+bool Xilinx::Axidma::_reset()
+{
+	_stats.resets++;
+
+	XAxiDma_Reset(&_xaxidma);
+
+	bool done = false;
+	for (unsigned timeout = _recovery.reset_timeout; !done && timeout; timeout--)
+		done = XAxiDma_ResetIsDone(&_xaxidma);
+
+	if (!done) {
+		_stats.reset_timeouts++;
+		error("DMA reset timed out");
+		return false;
+	}
+
+	/* the descriptor rings are stale after a reset */
+	if (_mode == Mode::SG && _create_bd_rings() != Result::OKAY)
+		return false;
+
+	/* reset clears the interrupt enable bits */
+	_setup_interrupts();
+
+	return true;
+}
+
+
+void Xilinx::Axidma::_recover(uint32_t tx_status, uint32_t rx_status)
+{
+	_stats.errors++;
+
+	uint32_t const status = tx_status | rx_status;
+	if (status & XAXIDMA_ERR_INTERNAL_MASK) _stats.internal++;
+	if (status & XAXIDMA_ERR_SLAVE_MASK)    _stats.slave++;
+	if (status & XAXIDMA_ERR_DECODE_MASK)   _stats.decode++;
+
+	error("DMA error (tx=", Hex(tx_status), ", rx=", Hex(rx_status), "), "
+	      "resetting device for recovery");
+
+	if (_mode == Mode::SG) {
+		_recover_bds(tx_status, rx_status);
+		return;
+	}
+
+	/* a reset affects both channels, hence all outstanding jobs are lost */
+	Job const tx_job = _tx_job;
+	Job const rx_job = _rx_job;
+	_tx_job.pending = false;
+	_rx_job.pending = false;
+
+	bool const reset_done = _reset();
+
+	bool const resubmit = reset_done && _recovery.resubmit &&
+	                      _retries < _recovery.max_retries &&
+	                      (tx_job.pending || rx_job.pending);
+
+	if (resubmit) {
+		_retries++;
+
+		/* restart rx before tx so that no data from the stream gets lost */
+		if (rx_job.pending &&
+		    _submit(DEVICE_TO_DMA, rx_job.dma_addr, rx_job.len) != Result::OKAY)
+			_stats.dropped++;
+		if (tx_job.pending &&
+		    _submit(DMA_TO_DEVICE, tx_job.dma_addr, tx_job.len) != Result::OKAY)
+			_stats.dropped++;
+
+		_stats.resubmissions++;
+	} else {
+		if (tx_job.pending) _stats.dropped++;
+		if (rx_job.pending) _stats.dropped++;
+		_retries = 0;
+	}
+
+	if (!_error_handler)
+		return;
+
+	if (tx_job.pending)
+		_error_handler->handle_transfer_error(Transfer_error {
+			DMA_TO_DEVICE, tx_job.dma_addr, tx_job.len, tx_status, resubmit });
+
+	if (rx_job.pending)
+		_error_handler->handle_transfer_error(Transfer_error {
+			DEVICE_TO_DMA, rx_job.dma_addr, rx_job.len, rx_status, resubmit });
+}
+
+
+/*
+ * Recovery in SG mode
+ *
+ * The reset discards the descriptors of all transfers handed to the
+ * device. Transfers whose descriptor has been completed without error are
+ * completed regularly, all others are resubmitted or reported as failed.
+ */
+void Xilinx::Axidma::_recover_bds(uint32_t tx_status, uint32_t rx_status)
+{
+	struct Outstanding
+	{
+		Direction dir;
+		addr_t    dma_addr;
+		size_t    len;
+		size_t    transferred;
+		bool      completed;
+	};
+
+	Outstanding bds[2*BD_COUNT];
+	unsigned    count = 0;
+
+	auto collect = [&] (Direction dir)
+	{
+		XAxiDma_BdRing &ring = _ring(dir);
+		XAxiDma_Bd     *bd   = ring.HwHead;
+
+		for (int i = 0; i < ring.HwCnt && count < 2*BD_COUNT; i++) {
+			u32 const sts = XAxiDma_BdGetSts(bd);
+			bds[count++] = Outstanding {
+				dir, (addr_t)XAxiDma_BdGetBufAddr(bd),
+				XAxiDma_BdGetLength(bd, ring.MaxTransferLen),
+				XAxiDma_BdGetActualLength(bd, ring.MaxTransferLen),
+				(sts & XAXIDMA_BD_STS_COMPLETE_MASK) && !(sts & XAXIDMA_BD_STS_ALL_ERR_MASK) };
+
+			bd = (XAxiDma_Bd *)XAxiDma_BdRingNext(&ring, bd);
+		}
+	};
+
+	if (_xaxidma.HasMm2S) collect(DMA_TO_DEVICE);
+	if (_xaxidma.HasS2Mm) collect(DEVICE_TO_DMA);
+
+	unsigned lost = 0;
+	for (unsigned i = 0; i < count; i++)
+		if (!bds[i].completed) lost++;
+
+	bool const reset_done = _reset();
+
+	bool const resubmit = reset_done && _recovery.resubmit &&
+	                      _retries < _recovery.max_retries && lost;
+
+	if (resubmit) {
+		_retries++;
+
+		/* restart rx before tx so that no data from the stream gets lost */
+		Direction const order[] = { DEVICE_TO_DMA, DMA_TO_DEVICE };
+		for (Direction dir : order)
+			for (unsigned i = 0; i < count; i++)
+				if (!bds[i].completed && bds[i].dir == dir &&
+				    _submit_bd(dir, bds[i].dma_addr, bds[i].len) != Result::OKAY)
+					_stats.dropped++;
+
+		_stats.resubmissions++;
+	} else {
+		_stats.dropped += lost;
+		_retries = 0;
+	}
+
+	for (unsigned i = 0; i < count; i++) {
+		Outstanding const &bd = bds[i];
+
+		if (bd.completed) {
+			_irq_stats.completions++;
+			if (bd.dir == DEVICE_TO_DMA)
+				_rx_transferred = bd.transferred;
+
+			Handler_base *handler = bd.dir == DMA_TO_DEVICE ? _tx_complete_handler
+			                                                : _rx_complete_handler;
+			if (handler)
+				handler->handle_transfer_complete();
+			continue;
+		}
+
+		if (_error_handler)
+			_error_handler->handle_transfer_error(Transfer_error {
+				bd.dir, bd.dma_addr, bd.len,
+				bd.dir == DMA_TO_DEVICE ? tx_status : rx_status, resubmit });
+	}
+}
+
+
+/*
+ * Complete all transfers whose descriptors have been processed
+ *
+ * With coalescing, a single interrupt covers several transfers, which are
+ * completed as a batch.
+ */
+void Xilinx::Axidma::_complete_bds(Direction dir)
+{
+	XAxiDma_BdRing &ring = _ring(dir);
+
+	XAxiDma_Bd *first = nullptr;
+	int const n = XAxiDma_BdRingFromHw(&ring, XAXIDMA_ALL_BDS, &first);
+	if (n <= 0)
+		return;
+
+	size_t      transferred[BD_COUNT];
+	XAxiDma_Bd *bd = first;
+	for (int i = 0; i < n; i++) {
+		transferred[i] = XAxiDma_BdGetActualLength(bd, ring.MaxTransferLen);
+		bd = (XAxiDma_Bd *)XAxiDma_BdRingNext(&ring, bd);
+	}
+
+	/* recycle the descriptors before the handlers submit new transfers */
+	XAxiDma_BdRingFree(&ring, n, first);
+
+	_irq_stats.completions += n;
+	_retries = 0;
+
+	Handler_base *handler = dir == DMA_TO_DEVICE ? _tx_complete_handler
+	                                             : _rx_complete_handler;
+	for (int i = 0; i < n; i++) {
+		if (dir == DEVICE_TO_DMA)
+			_rx_transferred = transferred[i];
+
+		if (handler)
+			handler->handle_transfer_complete();
+	}
+}
+
+
 void Xilinx::Axidma::_handle_irq()
 {
 	_rx_irq->ack();
 	_tx_irq->ack();
 
+	_irq_stats.irqs++;
+
 	/* read pending interrupts */
 	u32 tx_status = XAxiDma_IntrGetIrq(&_xaxidma, XAXIDMA_DMA_TO_DEVICE);
 	u32 rx_status = XAxiDma_IntrGetIrq(&_xaxidma, XAXIDMA_DEVICE_TO_DMA);
@@ -114,34 +512,91 @@ void Xilinx::Axidma::_handle_irq()
 
 	/* check for errors */
 	if (((tx_status|rx_status) & XAXIDMA_IRQ_ERROR_MASK)) {
-		error("DMA error, resetting device for recovery");
-
-		/* reset device */
-		XAxiDma_Reset(&_xaxidma);
+		_recover(XAxiDma_ReadReg(_xaxidma.RegBase + XAXIDMA_TX_OFFSET, XAXIDMA_SR_OFFSET),
+		         XAxiDma_ReadReg(_xaxidma.RegBase + XAXIDMA_RX_OFFSET, XAXIDMA_SR_OFFSET));
+		return;
+	}
 
-		for (unsigned timeout = 10000; timeout; timeout--) {
-			if (XAxiDma_ResetIsDone(&_xaxidma)) {
-				break;
-			}
-		}
+	if (_mode == Mode::SG) {
+		/* the threshold or the delay timer signals a batch of completions */
+		u32 const complete_mask = XAXIDMA_IRQ_IOC_MASK | XAXIDMA_IRQ_DELAY_MASK;
 
+		if ((tx_status & complete_mask)) _complete_bds(DMA_TO_DEVICE);
+		if ((rx_status & complete_mask)) _complete_bds(DEVICE_TO_DMA);
 		return;
 	}
 
 	if ((tx_status & XAXIDMA_IRQ_IOC_MASK)) {
+		_irq_stats.completions++;
+		_tx_job.pending = false;
 		if (_tx_complete_handler)
 			_tx_complete_handler->handle_transfer_complete();
 	}
 
 	if ((rx_status & XAXIDMA_IRQ_IOC_MASK)) {
+		_irq_stats.completions++;
+		_rx_job.pending = false;
 		if (_rx_complete_handler)
 			_rx_complete_handler->handle_transfer_complete();
 	}
+
+	if (!_tx_job.pending && !_rx_job.pending)
+		_retries = 0;
+}
+
+
+bool Xilinx::Axidma::_poll(unsigned window)
+{
+	auto done = [&] (Job const &job, UINTPTR base) {
+		if (!job.pending) return true;
+
+		u32 const sr = XAxiDma_ReadReg(base, XAXIDMA_SR_OFFSET);
+		return (sr & XAXIDMA_IDLE_MASK) || (sr & XAXIDMA_ERR_ALL_MASK);
+	};
+
+	for (unsigned i = 0; window == ~0U || i < window; i++) {
+		if (done(_tx_job, _xaxidma.RegBase + XAXIDMA_TX_OFFSET) &&
+		    done(_rx_job, _xaxidma.RegBase + XAXIDMA_RX_OFFSET))
+			return true;
+	}
+
+	return false;
+}
+
+
+bool Xilinx::Axidma::poll_completion()
+{
+	if (_mode != Mode::NORMAL || _completion == Completion::IRQ)
+		return false;
+
+	if (!_poll(_completion == Completion::POLL ? ~0U : _poll_window)) {
+		_poll_stats.fallbacks++;
+		return false;
+	}
+
+	u32 const tx_status = XAxiDma_IntrGetIrq(&_xaxidma, XAXIDMA_DMA_TO_DEVICE);
+	u32 const rx_status = XAxiDma_IntrGetIrq(&_xaxidma, XAXIDMA_DEVICE_TO_DMA);
+
+	/* leave errors to the interrupt handler */
+	if ((tx_status | rx_status) & XAXIDMA_IRQ_ERROR_MASK)
+		return false;
+
+	/* acknowledge completion so that the interrupt handler skips it */
+	XAxiDma_IntrAckIrq(&_xaxidma, tx_status, XAXIDMA_DMA_TO_DEVICE);
+	XAxiDma_IntrAckIrq(&_xaxidma, rx_status, XAXIDMA_DEVICE_TO_DMA);
+
+	_tx_job.pending = false;
+	_rx_job.pending = false;
+	_retries        = 0;
+
+	_poll_stats.polled++;
+	return true;
 }
 
 
 Xilinx::Axidma::Result Xilinx::Axidma::simple_transfer(Platform::Dma_buffer const &src_buf, size_t src_len,
-                                                       Platform::Dma_buffer const &dst_buf, size_t dst_len)
+                                                       Platform::Dma_buffer const &dst_buf, size_t dst_len,
+                                                       Completion completion)
 {
 	Result result { Result::OKAY };
 
@@ -153,57 +608,127 @@ Xilinx::Axidma::Result Xilinx::Axidma::simple_transfer(Platform::Dma_buffer cons
 	if (result != Result::OKAY)
 		return result;
 
-	do {
-		if (_mode == Mode::NORMAL)
-			_env.ep().wait_and_dispatch_one_io_signal();
+	unsigned long const dropped = _stats.dropped;
 
-	} while (!rx_transfer_complete() || !tx_transfer_complete());
+	auto status = [&] (unsigned offset) {
+		return XAxiDma_ReadReg(_xaxidma.RegBase + offset, XAXIDMA_SR_OFFSET); };
 
-	uint32_t status_reg = XAxiDma_ReadReg(_xaxidma.RegBase, XAXIDMA_SR_OFFSET);
-	if (status_reg & XAXIDMA_ERR_ALL_MASK) {
-		error("Xilinx::Axidma::simple_transfer: failed (", Hex(status_reg), ")");
-		return Result::DEVICE_ERROR;
+	auto channel_error = [&] () {
+		return (status(XAXIDMA_TX_OFFSET) | status(XAXIDMA_RX_OFFSET)) & XAXIDMA_ERR_ALL_MASK; };
+
+	bool polled = false;
+	for (;;) {
+		/* busy-poll for completion unless in IRQ completion mode */
+		polled = false;
+		if (_mode == Mode::NORMAL && completion != Completion::IRQ) {
+			polled = _poll(completion == Completion::POLL ? ~0U : _poll_window);
+			if (polled) _poll_stats.polled++;
+			else        _poll_stats.fallbacks++;
+		}
+
+		while (!polled) {
+			if (_mode != Mode::SIMPLE)
+				_env.ep().wait_and_dispatch_one_io_signal();
+
+			/* transfer has been dropped by the error recovery */
+			if (_stats.dropped != dropped) {
+				error("Xilinx::Axidma::simple_transfer: failed");
+				return Result::DEVICE_ERROR;
+			}
+
+			/* a halted channel never becomes idle */
+			if (channel_error())
+				break;
+
+			if (rx_transfer_complete() && tx_transfer_complete())
+				break;
+		}
+
+		uint32_t const tx_status = status(XAXIDMA_TX_OFFSET);
+		uint32_t const rx_status = status(XAXIDMA_RX_OFFSET);
+
+		if (!((tx_status | rx_status) & XAXIDMA_ERR_ALL_MASK))
+			break;
+
+		/*
+		 * Errors not seen by the interrupt handler take the same recovery
+		 * path, which may restart the transfers
+		 */
+		unsigned long const resubmissions = _stats.resubmissions;
+
+		_recover(tx_status, rx_status);
+
+		if (_stats.dropped != dropped || _stats.resubmissions == resubmissions) {
+			error("Xilinx::Axidma::simple_transfer: failed (", Hex(tx_status | rx_status), ")");
+			return Result::DEVICE_ERROR;
+		}
+
+		/* wait for the restarted transfers */
+	}
+
+	if (polled) {
+		/* acknowledge completion so that the interrupt handler skips it */
+		XAxiDma_IntrAckIrq(&_xaxidma, XAXIDMA_IRQ_IOC_MASK | XAXIDMA_IRQ_DELAY_MASK,
+		                   XAXIDMA_DMA_TO_DEVICE);
+		XAxiDma_IntrAckIrq(&_xaxidma, XAXIDMA_IRQ_IOC_MASK | XAXIDMA_IRQ_DELAY_MASK,
+		                   XAXIDMA_DEVICE_TO_DMA);
+		_tx_job.pending = false;
+		_rx_job.pending = false;
 	}
 
 	return Result::OKAY;
 }
 
 
-Xilinx::Axidma::Result Xilinx::Axidma::start_tx_transfer(Platform::Dma_buffer const &buf, size_t len)
+Xilinx::Axidma::Result Xilinx::Axidma::_submit(Direction dir, addr_t dma_addr, size_t len)
 {
-	if (_mode == Mode::SG) {
-		error("Axidma device has not been initialised for simple transfers");
-		return CONFIG_ERROR;
-	}
+	if (_mode == Mode::SG)
+		return _submit_bd(dir, dma_addr, len);
+
+	bool const tx = dir == DMA_TO_DEVICE;
 
 	int status = XAxiDma_SimpleTransfer(&_xaxidma,
-	                                    buf.dma_addr(),
+	                                    dma_addr,
 	                                    len,
-	                                    XAXIDMA_DMA_TO_DEVICE);
+	                                    tx ? XAXIDMA_DMA_TO_DEVICE
+	                                       : XAXIDMA_DEVICE_TO_DMA);
 
 	if (status != XST_SUCCESS) {
-		error("XAxiDma_SimpleTransfer() failed (DMA_TO_DEVICE)");
+		error("XAxiDma_SimpleTransfer() failed (", tx ? "DMA_TO_DEVICE" : "DEVICE_TO_DMA", ")");
 		return Result::DEVICE_ERROR;
 	}
 
+	(tx ? _tx_job : _rx_job) = Job { dma_addr, len, true };
+
 	return Result::OKAY;
 }
 
 
-Xilinx::Axidma::Result Xilinx::Axidma::start_rx_transfer(Platform::Dma_buffer const &buf, size_t len)
+Xilinx::Axidma::Result Xilinx::Axidma::_submit_bd(Direction dir, addr_t dma_addr, size_t len)
 {
-	if (_mode == Mode::SG) {
-		error("Axidma device has not been initialised for simple transfers");
-		return CONFIG_ERROR;
+	bool const      tx   = dir == DMA_TO_DEVICE;
+	XAxiDma_BdRing &ring = _ring(dir);
+
+	XAxiDma_Bd *bd = nullptr;
+	if (XAxiDma_BdRingAlloc(&ring, 1, &bd) != XST_SUCCESS) {
+		error("no free descriptor (", tx ? "DMA_TO_DEVICE" : "DEVICE_TO_DMA", ")");
+		return Result::DEVICE_ERROR;
 	}
 
-	int status = XAxiDma_SimpleTransfer(&_xaxidma,
-	                                    buf.dma_addr(),
-	                                    len,
-	                                    XAXIDMA_DEVICE_TO_DMA);
+	if (XAxiDma_BdSetBufAddr(bd, dma_addr) != XST_SUCCESS ||
+	    XAxiDma_BdSetLength(bd, (u32)len, ring.MaxTransferLen) != XST_SUCCESS) {
+		error("invalid transfer of ", len, " bytes at ", Hex(dma_addr));
+		XAxiDma_BdRingUnAlloc(&ring, 1, bd);
+		return Result::CONFIG_ERROR;
+	}
 
+	XAxiDma_BdSetCtrl(bd, tx ? XAXIDMA_BD_CTRL_TXSOF_MASK | XAXIDMA_BD_CTRL_TXEOF_MASK : 0);
+	XAxiDma_BdSetId(bd, dma_addr);
+
+	int status = XAxiDma_BdRingToHw(&ring, 1, bd);
 	if (status != XST_SUCCESS) {
-		error("XAxiDma_SimpleTransfer() failed (DEVICE_TO_DMA)");
+		error("XAxiDma_BdRingToHw() failed (", tx ? "DMA_TO_DEVICE" : "DEVICE_TO_DMA", "): ", status);
+		XAxiDma_BdRingUnAlloc(&ring, 1, bd);
 		return Result::DEVICE_ERROR;
 	}
 
@@ -211,9 +736,72 @@ Xilinx::Axidma::Result Xilinx::Axidma::start_rx_transfer(Platform::Dma_buffer co
 }
 
 
+Xilinx::Axidma::Result Xilinx::Axidma::_start_transfer(Direction dir, addr_t dma_addr, size_t len)
+{
+	return _submit(dir, dma_addr, len);
+}
+
+
+Xilinx::Axidma::Result Xilinx::Axidma::start_tx_transfer(Platform::Dma_buffer const &buf, size_t len)
+{
+	return _start_transfer(DMA_TO_DEVICE, buf.dma_addr(), len);
+}
+
+
+Xilinx::Axidma::Result Xilinx::Axidma::start_rx_transfer(Platform::Dma_buffer const &buf, size_t len)
+{
+	return _start_transfer(DEVICE_TO_DMA, buf.dma_addr(), len);
+}
+
+
+Xilinx::Axidma::Result Xilinx::Axidma::start_rx_transfer(Platform::Dma_buffer const &buf,
+                                                         size_t offset, size_t len)
+{
+	if (offset + len > buf.size()) {
+		error("rx transfer exceeds DMA buffer");
+		return CONFIG_ERROR;
+	}
+
+	return _submit(DEVICE_TO_DMA, buf.dma_addr() + offset, len);
+}
+
+
+size_t Xilinx::Axidma::rx_transferred() const
+{
+	if (_mode == Mode::SG)
+		return _rx_transferred;
+
+	return XAxiDma_ReadReg(_xaxidma.RegBase + XAXIDMA_RX_OFFSET, XAXIDMA_BUFFLEN_OFFSET);
+}
+
+
+size_t Xilinx::Axidma::max_transfer_size() const
+{
+	return _xaxidma.RxBdRing[0].MaxTransferLen;
+}
+
+
 bool Xilinx::Axidma::tx_transfer_complete()
-{ return !XAxiDma_Busy(&_xaxidma, XAXIDMA_DMA_TO_DEVICE); }
+{
+	if (_mode == Mode::SG)
+		return !_ring(DMA_TO_DEVICE).HwCnt;
+
+	bool const complete = !XAxiDma_Busy(&_xaxidma, XAXIDMA_DMA_TO_DEVICE);
+	if (complete && _mode == Mode::SIMPLE)
+		_tx_job.pending = false;
+
+	return complete;
+}
 
 
 bool Xilinx::Axidma::rx_transfer_complete()
-{ return !XAxiDma_Busy(&_xaxidma, XAXIDMA_DEVICE_TO_DMA); }
+{
+	if (_mode == Mode::SG)
+		return !_ring(DEVICE_TO_DMA).HwCnt;
+
+	bool const complete = !XAxiDma_Busy(&_xaxidma, XAXIDMA_DEVICE_TO_DMA);
+	if (complete && _mode == Mode::SIMPLE)
+		_rx_job.pending = false;
+
+	return complete;
+}
@@ -0,0 +1,32 @@
+/*
+ * \brief  Cache maintenance for xilinx_common
+ * \author agent
+ * \date   2026-10-18
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <cpu/cache.h>
+
+/* Xilinx includes */
+#include <xil_cache.h>
+
+
+void Xil_DCacheFlushRange(INTPTR adr, u32 len)
+{
+	if (len)
+		Genode::cache_clean_invalidate_data((Genode::addr_t)adr, len);
+}
+
+
+void Xil_DCacheInvalidateRange(INTPTR adr, u32 len)
+{
+	if (len)
+		Genode::cache_invalidate_data((Genode::addr_t)adr, len);
+}
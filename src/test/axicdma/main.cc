@@ -0,0 +1,270 @@
+/*
+ * \brief  Test and benchmark for xilinx_axicdma
+ * \author agent
+ * \date   2026-10-18
+ *
+ * The component compares the throughput of CPU memcpy with blocking and
+ * queued AXI CDMA copies for uncached and cached DMA buffers of increasing
+ * size. For cached buffers, the CDMA numbers include the cache maintenance
+ * required before and after each copy. The results are logged and reported
+ * as a "results" report.
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <libc/component.h>
+#include <timer_session/connection.h>
+#include <base/attached_rom_dataspace.h>
+#include <os/reporter.h>
+#include <util/array.h>
+
+/* Xilinx port includes */
+#include <xilinx_axicdma.h>
+
+using namespace Genode;
+
+
+struct Result
+{
+	Cache    cache         { UNCACHED };
+	size_t   size          { 0 };
+	unsigned copies        { 0 };
+	uint64_t memcpy_us     { 0 };
+	uint64_t cdma_us       { 0 };
+	uint64_t cdma_async_us { 0 };
+
+	uint64_t kb_per_s(uint64_t us) const {
+		return us ? ((uint64_t)size * copies * 1000) / (us * 1024) : 0; }
+
+	void generate(Xml_generator &xml) const
+	{
+		xml.node("result", [&] () {
+			xml.attribute("cached",              cache == CACHED);
+			xml.attribute("size",                size);
+			xml.attribute("copies",              copies);
+			xml.attribute("memcpy_kb_per_s",     kb_per_s(memcpy_us));
+			xml.attribute("cdma_kb_per_s",       kb_per_s(cdma_us));
+			xml.attribute("cdma_async_kb_per_s", kb_per_s(cdma_async_us));
+		});
+	}
+};
+
+
+struct Main
+{
+	enum { MAX_RESULTS = 32 };
+
+	using Axicdma = Xilinx::Axicdma;
+
+	Env &env;
+
+	Attached_rom_dataspace config { env, "config" };
+
+	Platform::Connection platform { env };
+
+	Axicdma cdma { env, platform, mode_from_xml(), Axicdma::device_name(platform, 0) };
+
+	Axicdma::Copy_complete_handler<Main> complete_handler {
+		*this, &Main::handle_copy_complete };
+
+	Timer::Connection  timer    { env };
+	Expanding_reporter reporter { env, "results", "results" };
+
+	size_t   const min_size    { config.xml().attribute_value("min_size", Number_of_bytes { 4*1024 }) };
+	size_t   const max_size    { config.xml().attribute_value("max_size", Number_of_bytes { 8*1024*1024 }) };
+	size_t   const run_bytes   { config.xml().attribute_value("run_bytes", Number_of_bytes { 64*1024*1024 }) };
+	unsigned const queue_depth { min(config.xml().attribute_value("queue_depth", 8U),
+	                                 (unsigned)Axicdma::QUEUE_SIZE) };
+
+	Array<Result, MAX_RESULTS> results { };
+
+	/* state of queued copies */
+	unsigned completed { 0 };
+	unsigned failed    { 0 };
+
+	Axicdma::Mode mode_from_xml()
+	{
+		using Name = String<8>;
+
+		return config.xml().attribute_value("mode", Name("simple")) == "sg"
+		       ? Axicdma::SG : Axicdma::SIMPLE;
+	}
+
+	void handle_copy_complete(Axicdma::Copy const &, bool success)
+	{
+		completed++;
+		if (!success) failed++;
+	}
+
+	void fail(char const *msg)
+	{
+		error(msg);
+		env.parent().exit(1);
+		throw Exception();
+	}
+
+	uint64_t measure_memcpy(Platform::Dma_buffer &, Platform::Dma_buffer &, size_t, unsigned);
+	uint64_t measure_cdma(Platform::Dma_buffer &, Platform::Dma_buffer &, size_t, unsigned, Cache);
+	uint64_t measure_cdma_async(Platform::Dma_buffer &, Platform::Dma_buffer &, size_t, unsigned, Cache);
+	void     verify(Platform::Dma_buffer &, Platform::Dma_buffer &, size_t, Cache);
+	void     run(Cache, size_t);
+	void     report();
+
+	Main(Env &env) : env(env)
+	{
+		cdma.complete_handler(complete_handler);
+
+		log("benchmarking ", cdma.name(), " in ",
+		    cdma.mode() == Axicdma::SG ? "SG" : "simple", " mode");
+
+		Cache const caches[] { UNCACHED, CACHED };
+		for (Cache cache : caches)
+			for (size_t size = min_size; size <= max_size && results.count() < MAX_RESULTS; size *= 4)
+				run(cache, size);
+
+		log("Benchmark finished");
+		env.parent().exit(0);
+	}
+};
+
+
+uint64_t Main::measure_memcpy(Platform::Dma_buffer &dst, Platform::Dma_buffer &src,
+                              size_t size, unsigned copies)
+{
+	uint64_t const start_us = timer.elapsed_us();
+
+	for (unsigned i = 0; i < copies; i++)
+		Genode::memcpy(dst.local_addr<void>(), src.local_addr<void>(), size);
+
+	return timer.elapsed_us() - start_us;
+}
+
+
+uint64_t Main::measure_cdma(Platform::Dma_buffer &dst, Platform::Dma_buffer &src,
+                            size_t size, unsigned copies, Cache cache)
+{
+	uint64_t const start_us = timer.elapsed_us();
+
+	for (unsigned i = 0; i < copies; i++) {
+		if (cache == CACHED) {
+			Axicdma::sync_for_device(src, 0, size);
+			Axicdma::sync_for_device(dst, 0, size);
+		}
+
+		if (cdma.copy(dst, src, size) != Axicdma::OKAY)
+			fail("CDMA copy failed");
+
+		if (cache == CACHED)
+			Axicdma::sync_for_cpu(dst, 0, size);
+	}
+
+	return timer.elapsed_us() - start_us;
+}
+
+
+uint64_t Main::measure_cdma_async(Platform::Dma_buffer &dst, Platform::Dma_buffer &src,
+                                  size_t size, unsigned copies, Cache cache)
+{
+	completed = 0;
+	failed    = 0;
+
+	uint64_t const start_us = timer.elapsed_us();
+
+	/* all copies use the same buffers, hence maintain the cache only once */
+	if (cache == CACHED) {
+		Axicdma::sync_for_device(src, 0, size);
+		Axicdma::sync_for_device(dst, 0, size);
+	}
+
+	unsigned submitted = 0;
+	while (completed < copies) {
+		while (submitted < copies && cdma.pending() < queue_depth) {
+			if (cdma.submit(dst, 0, src, 0, size, submitted) != Axicdma::OKAY)
+				fail("CDMA submit failed");
+			submitted++;
+		}
+
+		env.ep().wait_and_dispatch_one_io_signal();
+	}
+
+	if (cache == CACHED)
+		Axicdma::sync_for_cpu(dst, 0, size);
+
+	uint64_t const duration = timer.elapsed_us() - start_us;
+
+	if (failed)
+		fail("queued CDMA copies failed");
+
+	return duration;
+}
+
+
+void Main::verify(Platform::Dma_buffer &dst, Platform::Dma_buffer &src, size_t size, Cache cache)
+{
+	Genode::memset(dst.local_addr<void>(), 0, size);
+
+	if (cache == CACHED) {
+		Axicdma::sync_for_device(src, 0, size);
+		Axicdma::sync_for_device(dst, 0, size);
+	}
+
+	if (cdma.copy(dst, src, size) != Axicdma::OKAY)
+		fail("CDMA copy failed");
+
+	if (cache == CACHED)
+		Axicdma::sync_for_cpu(dst, 0, size);
+
+	if (Genode::memcmp(dst.local_addr<void>(), src.local_addr<void>(), size))
+		fail("CDMA copy failed - Data error");
+}
+
+
+void Main::run(Cache cache, size_t size)
+{
+	Platform::Dma_buffer src { platform, size, cache };
+	Platform::Dma_buffer dst { platform, size, cache };
+
+	uint32_t *words = src.local_addr<uint32_t>();
+	for (size_t i = 0; i < size / sizeof(uint32_t); i++)
+		words[i] = (uint32_t)i;
+
+	verify(dst, src, size, cache);
+
+	Result result { };
+	result.cache         = cache;
+	result.size          = size;
+	result.copies        = (unsigned)max(run_bytes / size, (size_t)1);
+	result.memcpy_us     = measure_memcpy(dst, src, size, result.copies);
+	result.cdma_us       = measure_cdma(dst, src, size, result.copies, cache);
+	result.cdma_async_us = measure_cdma_async(dst, src, size, result.copies, cache);
+
+	log(cache == CACHED ? "cached" : "uncached", " ", Number_of_bytes(size), ": ",
+	    "memcpy ",     result.kb_per_s(result.memcpy_us),     " KB/s, ",
+	    "cdma ",       result.kb_per_s(result.cdma_us),       " KB/s, ",
+	    "cdma queued ", result.kb_per_s(result.cdma_async_us), " KB/s");
+
+	results.add(result);
+	report();
+}
+
+
+void Main::report()
+{
+	reporter.generate([&] (Xml_generator &xml) {
+		xml.attribute("device", cdma.name());
+		xml.attribute("mode",   cdma.mode() == Axicdma::SG ? "sg" : "simple");
+		for (unsigned i = 0; i < results.count(); i++)
+			results.value(i).generate(xml);
+	});
+}
+
+
+void Libc::Component::construct(Env &env) {
+	static Main main(env);
+}
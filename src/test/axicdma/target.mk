@@ -0,0 +1,6 @@
+TARGET = test-axicdma
+
+REQUIRES := arm_v7a
+LIBS = base libc xilinx_axicdma
+
+SRC_CC += main.cc
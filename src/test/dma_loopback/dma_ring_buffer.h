@@ -15,54 +15,28 @@
 #define _DMA_RING_BUFFER_H_
 
 /* Genode includes */
-#include <util/lazy_array.h>
+#include <util/spsc_ring.h>
 #include <platform_session/connection.h>
+#include <platform_session/dma_arena.h>
 
-struct Dma_ring_buffer {
-
-	struct Dma_buffer_pair {
-		Platform::Dma_buffer &tx;
-		Platform::Dma_buffer &rx;
-	};
-
-	unsigned _tail { 0 };
-	unsigned _head { 0 };
-
-	Genode::Lazy_array<Platform::Dma_buffer, 3> _tx_buffers;
-	Genode::Lazy_array<Platform::Dma_buffer, 3> _rx_buffers;
-
-	Dma_ring_buffer(Platform::Connection &platform, Genode::size_t element_size, Genode::Cache cache)
-	: _tx_buffers(3, platform, element_size, cache),
-	  _rx_buffers(3, platform, element_size, cache)
+/*
+ * The buffers are placed in a shared arena so that all buffers of a run are
+ * covered by few segments of the DMA guard
+ */
+struct Dma_buffer_pair
+{
+	Platform::Dma_arena::Buffer tx;
+	Platform::Dma_arena::Buffer rx;
+
+	Dma_buffer_pair(Platform::Dma_arena &arena, Genode::size_t size)
+	: tx(arena, size),
+	  rx(arena, size)
 	{ }
+};
 
-	bool advance_head() {
-		if ((_head+1) % _rx_buffers.count() != _tail) {
-			_head = (_head+1) % _rx_buffers.count();
-			return true;
-		}
-
-		return false;
-	}
-
-	bool advance_tail() {
-		if (!empty()) {
-			_tail = (_tail+1) % _rx_buffers.count();
-			return true;
-		}
-
-		return false;
-	}
-
-	Dma_buffer_pair head() {
-		return Dma_buffer_pair { _tx_buffers.value(_head), _rx_buffers.value(_head) };
-	}
-
-	Dma_buffer_pair tail() {
-		return Dma_buffer_pair { _tx_buffers.value(_tail), _rx_buffers.value(_tail) };
-	}
+enum { MAX_QUEUE_DEPTH = 32 };
 
-	bool empty() { return _head == _tail; }
-};
+/* the queue depth (ring capacity) must be a power of two */
+using Dma_ring_buffer = Genode::Spsc_ring<Dma_buffer_pair, MAX_QUEUE_DEPTH>;
 
 #endif /* _DMA_RING_BUFFER_H_ */
@@ -0,0 +1,140 @@
+/*
+ * \brief  Per-transfer latency samples
+ * \author agent
+ * \date   2026-10-18
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _LATENCY_SAMPLES_H_
+#define _LATENCY_SAMPLES_H_
+
+/* Genode includes */
+#include <trace/timestamp.h>
+
+/* libc includes */
+#include <stdlib.h>
+
+/*
+ * Histogram of latencies with power-of-two buckets
+ *
+ * Bucket i counts the latencies in [2^i, 2^(i+1)) ticks, bucket 0 also
+ * counts latencies of 0 ticks.
+ */
+struct Latency_histogram
+{
+	using Timestamp = Genode::Trace::Timestamp;
+
+	enum { BUCKETS = 40 };
+
+	unsigned long _buckets[BUCKETS] { };
+
+	static unsigned _bucket(Timestamp value)
+	{
+		unsigned i = 0;
+		for (; value > 1 && i < BUCKETS - 1; value >>= 1)
+			i++;
+		return i;
+	}
+
+	void add(Timestamp value) { _buckets[_bucket(value)]++; }
+
+	void reset()
+	{
+		for (unsigned long &count : _buckets)
+			count = 0;
+	}
+
+	/*
+	 * Call 'fn(lower, upper, count)' for each non-empty bucket
+	 */
+	template <typename FN>
+	void for_each_bucket(FN const &fn) const
+	{
+		for (unsigned i = 0; i < BUCKETS; i++)
+			if (_buckets[i])
+				fn(i ? 1ULL << i : 0ULL, (1ULL << (i + 1)) - 1, _buckets[i]);
+	}
+
+	void print(Genode::Output &out) const
+	{
+		bool first = true;
+		for_each_bucket([&] (Timestamp lower, Timestamp upper, unsigned long count) {
+			Genode::print(out, first ? "" : " ", lower, "-", upper, ":", count);
+			first = false;
+		});
+	}
+};
+
+
+/*
+ * Records up to MAX_SAMPLES latencies (in timestamp ticks) for computing
+ * exact percentiles. Further samples are only accounted for the maximum
+ * and the histogram.
+ */
+struct Latency_samples
+{
+	using Timestamp = Genode::Trace::Timestamp;
+
+	enum { MAX_SAMPLES = 4096 };
+
+	Timestamp _samples[MAX_SAMPLES] { };
+	unsigned  _count  { 0 };
+	Timestamp _max    { 0 };
+	bool      _sorted { false };
+
+	Latency_histogram histogram { };
+
+	static int _compare(void const *a, void const *b)
+	{
+		Timestamp const x = *(Timestamp const *)a;
+		Timestamp const y = *(Timestamp const *)b;
+		return (x > y) - (x < y);
+	}
+
+	void add(Timestamp value)
+	{
+		if (value > _max)
+			_max = value;
+
+		if (_count < MAX_SAMPLES)
+			_samples[_count++] = value;
+
+		histogram.add(value);
+
+		_sorted = false;
+	}
+
+	void reset()
+	{
+		_count  = 0;
+		_max    = 0;
+		_sorted = false;
+		histogram.reset();
+	}
+
+	Timestamp max() const { return _max; }
+
+	/*
+	 * Return the given percentile (sorts the samples on first call)
+	 */
+	Timestamp percentile(unsigned p)
+	{
+		if (!_count)
+			return 0;
+
+		if (!_sorted) {
+			qsort(_samples, _count, sizeof(Timestamp), _compare);
+			_sorted = true;
+		}
+
+		return _samples[((unsigned long)(_count - 1) * p) / 100];
+	}
+};
+
+#endif /* _LATENCY_SAMPLES_H_ */
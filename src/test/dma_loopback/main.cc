@@ -2,6 +2,20 @@
  * \brief  Test component for xilinx_axidma
  * \author Johannes Schlatow
  * \date   2022-11-11
+ *
+ * After a simple transfer test, the component performs a benchmark of
+ * loopback transfers. The benchmark consists of a sequence of runs, each of
+ * which performs a fixed number of transfers with a particular buffer size,
+ * access size, queue depth and completion mode. The runs are specified by
+ * '<run>' and '<sweep>' nodes in the config.
+ *
+ * The content of all buffers is generated before a run starts. On the
+ * measured path, only 'access_size' bytes of each buffer are written
+ * before and verified after each transfer to model CPU-side processing.
+ * The results, including a histogram of the transfer latencies, are logged
+ * and reported as a "results" report. At the end, the median latencies of
+ * the completion modes are compared for each transfer size to show where
+ * polling stops paying off against the interrupt.
  */
 
 /*
@@ -15,46 +29,179 @@
 #include <libc/component.h>
 #include <timer_session/connection.h>
 #include <base/attached_rom_dataspace.h>
+#include <base/heap.h>
+#include <os/reporter.h>
+#include <util/array.h>
 
 /* Xilinx port includes */
 #include <xilinx_axidma.h>
 
 /* local includes */
 #include <dma_ring_buffer.h>
+#include <latency_samples.h>
 
 using namespace Genode;
 
+using Completion = Xilinx::Axidma::Completion;
+
+
+struct Run
+{
+	size_t     buffer_size { 8*1024 };
+	size_t     access_size { 64 };
+	unsigned   queue_depth { 2 };
+	unsigned   transfers   { 1000 };
+	Completion completion  { Completion::IRQ };
+
+	static Completion completion_from_xml(Xml_node const &node, Completion def)
+	{
+		using Name = String<16>;
+
+		Name const name = node.attribute_value("completion", Name());
+		if (name == "irq")    return Completion::IRQ;
+		if (name == "poll")   return Completion::POLL;
+		if (name == "hybrid") return Completion::HYBRID;
+
+		return def;
+	}
+
+	static char const *completion_name(Completion completion)
+	{
+		switch (completion) {
+		case Completion::IRQ:    return "irq";
+		case Completion::POLL:   return "poll";
+		case Completion::HYBRID: return "hybrid";
+		}
+		return "";
+	}
+
+	/* read parameters common to <run> and <sweep> nodes */
+	static Run from_xml(Xml_node const &node)
+	{
+		Run run { };
+		run.buffer_size = node.attribute_value("buffer_size", Number_of_bytes { run.buffer_size });
+		run.access_size = node.attribute_value("access_size", Number_of_bytes { run.access_size });
+		run.queue_depth = node.attribute_value("queue_depth", run.queue_depth);
+		run.transfers   = node.attribute_value("transfers",   run.transfers);
+		run.completion  = completion_from_xml(node, run.completion);
+		return run;
+	}
+};
+
+
+struct Run_result
+{
+	Run              run            { };
+	uint64_t         bytes          { 0 };
+	uint64_t         duration_us    { 0 };
+	Trace::Timestamp latency_p50    { 0 };
+	Trace::Timestamp latency_p90    { 0 };
+	Trace::Timestamp latency_p99    { 0 };
+	Trace::Timestamp latency_max    { 0 };
+	unsigned long    irqs           { 0 };
+	unsigned long    polled         { 0 };
+	unsigned long    fallbacks      { 0 };
+	unsigned long    errors         { 0 };
+
+	Latency_histogram histogram     { };
+
+	uint64_t kb_per_s() const {
+		return duration_us ? (bytes * 1000) / (duration_us * 1024) : 0; }
+
+	void generate(Xml_generator &xml) const
+	{
+		xml.node("run", [&] () {
+			xml.attribute("buffer_size", run.buffer_size);
+			xml.attribute("access_size", run.access_size);
+			xml.attribute("queue_depth", run.queue_depth);
+			xml.attribute("completion",  Run::completion_name(run.completion));
+			xml.attribute("transfers",   run.transfers);
+			xml.attribute("bytes",       bytes);
+			xml.attribute("duration_us", duration_us);
+			xml.attribute("kb_per_s",    kb_per_s());
+			xml.attribute("latency_p50", latency_p50);
+			xml.attribute("latency_p90", latency_p90);
+			xml.attribute("latency_p99", latency_p99);
+			xml.attribute("latency_max", latency_max);
+			xml.attribute("irqs",        irqs);
+			xml.attribute("polled",      polled);
+			xml.attribute("fallbacks",   fallbacks);
+			xml.attribute("errors",      errors);
+
+			xml.node("histogram", [&] () {
+				xml.attribute("unit", "ticks");
+				histogram.for_each_bucket([&] (Trace::Timestamp lower,
+				                               Trace::Timestamp upper,
+				                               unsigned long    count) {
+					xml.node("bucket", [&] () {
+						xml.attribute("lower", lower);
+						xml.attribute("upper", upper);
+						xml.attribute("count", count);
+					});
+				});
+			});
+		});
+	}
+};
+
+
 struct Main {
 
-	Env            &env;
+	enum { MAX_RUNS = 128 };
+
+	using Port = String<16>;
+
+	Env                    &env;
+
+	Attached_rom_dataspace  config   { env, "config" };
 
-	Xilinx::Axidma  axidma  { env, Xilinx::Axidma::Mode::NORMAL };
+	Platform::Connection    platform { env };
+
+	Xilinx::Axidma          axidma   { env, platform, Xilinx::Axidma::Mode::NORMAL,
+	                                   device_from_xml() };
 
 	Xilinx::Axidma::Transfer_complete_handler<Main> rx_handler {
 		*this, &Main::handle_rx_complete };
 
-	Attached_rom_dataspace config { env, "config" };
+	Xilinx::Axidma::Transfer_error_handler<Main> error_handler {
+		*this, &Main::handle_error };
 
 	Cache         cache           { cache_from_xml() };
-	size_t        max_buffer_size { config.xml().attribute_value("max_size", Number_of_bytes { 32*1024*1024 }) };
-	size_t        cur_buffer_size { 8*1024 };
-
-	size_t        max_access_size { 64*1024 };
-	size_t        min_access_size { 64 };
-	size_t        cur_access_size { min_access_size };
-
-	/* timer for throughput reporting */
-	using Periodic_timeout = Timer::Periodic_timeout<Main>;
-	Timer::Connection               timer   { env };
-	Constructible<Periodic_timeout> timeout { };
-
-	/* state for throughput test */
-	unsigned                        last_counter { 0 };
-	unsigned                        counter      { 0 };
-	unsigned                        rx_counter   { 0 };
-	Dma_ring_buffer                 buffers      { axidma.platform(),
-	                                               max_buffer_size,
-	                                               cache };
+	Port          port            { config.xml().attribute_value("port", Port("hp")) };
+	bool          verify          { config.xml().attribute_value("verify", true) };
+	unsigned      poll_window     { config.xml().attribute_value("poll_window", 2000U) };
+
+	Timer::Connection  timer    { env };
+	Expanding_reporter reporter { env, "results", "results" };
+
+	Heap                heap      { env.ram(), env.rm() };
+	Platform::Dma_arena dma_arena { platform, heap, cache };
+
+	Array<Run, MAX_RUNS>        runs    { };
+	Array<Run_result, MAX_RUNS> results { };
+
+	/* state of current run */
+	unsigned                        cur_run    { 0 };
+	unsigned                        counter    { 0 };
+	unsigned                        rx_counter { 0 };
+	unsigned                        completed  { 0 };
+	uint64_t                        start_us   { 0 };
+	Trace::Timestamp                start_ts   { 0 };
+	Latency_samples                 latencies  { };
+	Constructible<Dma_ring_buffer>  buffers    { };
+
+	Xilinx::Axidma::Irq_stats   irq_stats_start   { };
+	Xilinx::Axidma::Poll_stats  poll_stats_start  { };
+	Xilinx::Axidma::Error_stats error_stats_start { };
+
+	/* use device given by 'device' attribute or first axi_dma device */
+	Platform::Device::Name device_from_xml()
+	{
+		using Name = Platform::Device::Name;
+
+		Name const name = config.xml().attribute_value("device", Name());
+		return name != "" ? name : Xilinx::Axidma::device_name(platform, 0);
+	}
 
 	Cache cache_from_xml()
 	{
@@ -62,50 +209,88 @@ struct Main {
 		return cached ? CACHED : UNCACHED;
 	}
 
+	void add_run(Run const &run)
+	{
+		if (runs.count() >= MAX_RUNS) {
+			warning("ignoring run, maximum number of runs reached");
+			return;
+		}
+
+		if (run.access_size > run.buffer_size || run.access_size < sizeof(unsigned)) {
+			warning("ignoring run with invalid access size ", run.access_size);
+			return;
+		}
+
+		if (!run.queue_depth || run.queue_depth > MAX_QUEUE_DEPTH ||
+		    (run.queue_depth & (run.queue_depth - 1))) {
+			warning("ignoring run with invalid queue depth ", run.queue_depth);
+			return;
+		}
+
+		runs.add(run);
+	}
+
+	/* add runs for all combinations of buffer and access sizes (step factor 4) */
+	void add_sweep(Run const &base, size_t max_buffer_size, size_t max_access_size)
+	{
+		for (size_t bs = base.buffer_size; bs <= max_buffer_size; bs *= 4) {
+			for (size_t as = base.access_size; as <= min(bs, max_access_size); as *= 4) {
+				Run run = base;
+				run.buffer_size = bs;
+				run.access_size = as;
+				add_run(run);
+			}
+		}
+	}
+
+	void runs_from_xml()
+	{
+		config.xml().for_each_sub_node([&] (Xml_node const &node) {
+			if (node.has_type("run"))
+				add_run(Run::from_xml(node));
+
+			if (node.has_type("sweep")) {
+				Run const base = Run::from_xml(node);
+				add_sweep(base,
+				          node.attribute_value("max_buffer_size", Number_of_bytes { base.buffer_size }),
+				          node.attribute_value("max_access_size", Number_of_bytes { base.access_size }));
+			}
+		});
+
+		/* default sweep */
+		if (!runs.count())
+			add_sweep(Run { }, config.xml().attribute_value("max_size", Number_of_bytes { 32*1024*1024 }),
+			          64*1024);
+	}
+
 	/* simple transfer test */
 	void test_simple_transfer(size_t, uint8_t);
 
-	/* methods for throughput test */
+	/* methods for benchmark */
 	void handle_rx_complete();
+	void handle_error(Xilinx::Axidma::Transfer_error const &);
+	void generate_data();
 	void fill_transfers();
 	void queue_next_transfer();
+	void complete_transfer();
+	void kick();
+	void start_run();
+	void finish_run();
+	void report();
+	void log_crossover();
 
 	Main(Env & env) : env(env)
 	{
 		test_simple_transfer(8192,  0x21);
 
-		/* prepare throughput test */
-		axidma.rx_complete_handler(rx_handler);
-		fill_transfers();
-
-		/* start periodic timer for throughput logging */
-		timeout.construct(timer, *this, &Main::handle_timeout, Microseconds { 1000 * 2000U });
-
-		/* start throughput test */
-		queue_next_transfer();
-	}
-
-	void handle_timeout(Duration)
-	{
-		unsigned long transmitted = counter - last_counter;
-		last_counter = counter;
-
-		if (transmitted == last_counter)
-			return;
-
-		log("Current loopback throughput: ", ((transmitted * cur_buffer_size) / 2000000UL),
-		    "MB/s with ", cur_buffer_size/1024,
-		    "KB buffers and access size ", cur_access_size);
+		runs_from_xml();
 
-		cur_access_size *= 4;
-		if (cur_access_size > max_access_size || cur_access_size > cur_buffer_size) {
-			cur_access_size = min_access_size;
+		/* prepare benchmark */
+		axidma.rx_complete_handler(rx_handler);
+		axidma.error_handler(error_handler);
+		axidma.recovery_config(Xilinx::Axidma::Recovery_config { true, 3, 10000 });
 
-			log("");
-			cur_buffer_size *= 4;
-			if (cur_buffer_size > max_buffer_size)
-				env.parent().exit(0);
-		}
+		start_run();
 	}
 };
 
@@ -119,6 +304,11 @@ void Main::test_simple_transfer(size_t size, uint8_t value)
 	Genode::memset(src_buffer.local_addr<void>(), value, size);
 	Genode::memset(dst_buffer.local_addr<void>(), value != 0 ? 0 : -1, size);
 
+	if (cache == CACHED) {
+		Xilinx::Axidma::sync_for_device(src_buffer, size);
+		Xilinx::Axidma::sync_for_device(dst_buffer, size);
+	}
+
 	log("initiating simple transfer of size ", (unsigned)size);
 
 	/* perform DMA transfer */
@@ -128,6 +318,9 @@ void Main::test_simple_transfer(size_t size, uint8_t value)
 		return;
 	}
 
+	if (cache == CACHED)
+		Xilinx::Axidma::sync_for_cpu(dst_buffer, size);
+
 	/* compare buffers */
 	if (Genode::memcmp(src_buffer.local_addr<void>(), dst_buffer.local_addr<void>(), size)) {
 		error("DMA transfer failed - Data error");
@@ -137,64 +330,265 @@ void Main::test_simple_transfer(size_t size, uint8_t value)
 }
 
 
-void Main::handle_rx_complete()
+void Main::start_run()
 {
-	if (!axidma.rx_transfer_complete())
+	if (cur_run >= runs.count()) {
+		log_crossover();
+		log("Benchmark finished");
+		env.parent().exit(0);
 		return;
+	}
 
-	/* compare the first cur_access_size bytes of src and dst buffers */
-	Dma_ring_buffer::Dma_buffer_pair bufs = buffers.tail();
-	if (Genode::memcmp(bufs.tx.local_addr<void>(),
-		                bufs.rx.local_addr<void>(), cur_access_size)) {
-		error("DMA failed - Data error");
-		env.parent().exit(1);
+	Run const &run = runs.value(cur_run);
+
+	buffers.destruct();
+	buffers.construct(run.queue_depth, dma_arena, run.buffer_size);
+
+	axidma.completion(run.completion, poll_window);
+
+	/* data generation is not part of the measured path */
+	generate_data();
+
+	counter    = 0;
+	rx_counter = 0;
+	completed  = 0;
+	latencies.reset();
+
+	irq_stats_start   = axidma.irq_stats();
+	poll_stats_start  = axidma.poll_stats();
+	error_stats_start = axidma.error_stats();
+
+	start_us = timer.elapsed_us();
+
+	fill_transfers();
+	kick();
+}
+
+
+void Main::finish_run()
+{
+	uint64_t const end_us = timer.elapsed_us();
+
+	Run const &run = runs.value(cur_run);
+
+	Run_result result { };
+	result.run         = run;
+	result.bytes       = (uint64_t)run.buffer_size * completed;
+	result.duration_us = end_us - start_us;
+	result.latency_p50 = latencies.percentile(50);
+	result.latency_p90 = latencies.percentile(90);
+	result.latency_p99 = latencies.percentile(99);
+	result.latency_max = latencies.max();
+	result.irqs        = axidma.irq_stats().irqs        - irq_stats_start.irqs;
+	result.polled      = axidma.poll_stats().polled     - poll_stats_start.polled;
+	result.fallbacks   = axidma.poll_stats().fallbacks  - poll_stats_start.fallbacks;
+	result.errors      = axidma.error_stats().errors    - error_stats_start.errors;
+	result.histogram   = latencies.histogram;
+
+	log("run ", cur_run, ": ",
+	    run.buffer_size, " bytes, access ", run.access_size,
+	    ", depth ", run.queue_depth,
+	    ", ", Run::completion_name(run.completion),
+	    ": ", result.kb_per_s(), " KB/s, latency [ticks] p50=", result.latency_p50,
+	    " p90=", result.latency_p90, " p99=", result.latency_p99,
+	    " max=", result.latency_max);
+	log("run ", cur_run, ": histogram [ticks] ", result.histogram);
+
+	results.add(result);
+	report();
+
+	cur_run++;
+	start_run();
+}
+
+
+void Main::report()
+{
+	reporter.generate([&] (Xml_generator &xml) {
+		xml.attribute("cached", cache == CACHED);
+		xml.attribute("port", port);
+		for (unsigned i = 0; i < results.count(); i++)
+			results.value(i).generate(xml);
+	});
+}
+
+
+/*
+ * Log the median latencies of all completion modes for each run of the IRQ
+ * mode for which runs with the same parameters in other modes exist
+ */
+void Main::log_crossover()
+{
+	auto same_parameters = [] (Run const &a, Run const &b) {
+		return a.buffer_size == b.buffer_size && a.access_size == b.access_size
+		    && a.queue_depth == b.queue_depth; };
+
+	for (unsigned i = 0; i < results.count(); i++) {
+		Run_result const &irq = results.value(i);
+		if (irq.run.completion != Completion::IRQ)
+			continue;
+
+		Run_result const *poll   = nullptr;
+		Run_result const *hybrid = nullptr;
+		for (unsigned j = 0; j < results.count(); j++) {
+			Run_result const &r = results.value(j);
+			if (!same_parameters(r.run, irq.run))
+				continue;
+
+			if (r.run.completion == Completion::POLL)   poll   = &r;
+			if (r.run.completion == Completion::HYBRID) hybrid = &r;
+		}
+
+		if (!poll && !hybrid)
+			continue;
+
+		Run_result const *fastest  = &irq;
+		Run_result const *others[] = { poll, hybrid };
+		for (Run_result const *r : others)
+			if (r && r->latency_p50 < fastest->latency_p50)
+				fastest = r;
+
+		log("crossover ", irq.run.buffer_size, " bytes: p50 [ticks]"
+		    " irq=", irq.latency_p50,
+		    " poll=",   poll   ? poll->latency_p50   : 0ULL,
+		    " hybrid=", hybrid ? hybrid->latency_p50 : 0ULL,
+		    ", fastest ", Run::completion_name(fastest->run.completion));
 	}
-	/* check whether memory content has the expected value */
-	else if (*bufs.tx.local_addr<unsigned>() != rx_counter++) {
-		error("Expected ", rx_counter-1, " but got ", *bufs.tx.local_addr<unsigned>());
+}
+
+
+void Main::generate_data()
+{
+	size_t const size = runs.value(cur_run).buffer_size;
+
+	buffers->for_each([&] (Dma_buffer_pair &bufs) {
+		uint8_t *tx = bufs.tx.local_addr<uint8_t>();
+		for (size_t i = 0; i < size; i++)
+			tx[i] = (uint8_t)i;
+
+		Genode::memset(bufs.rx.local_addr<void>(), 0xff, size);
+
+		if (cache == CACHED) {
+			Xilinx::Axidma::sync_for_device(bufs.tx, size);
+			Xilinx::Axidma::sync_for_device(bufs.rx, size);
+		}
+	});
+}
+
+
+void Main::handle_error(Xilinx::Axidma::Transfer_error const &e)
+{
+	warning("DMA ", e.direction == Xilinx::Axidma::DMA_TO_DEVICE ? "tx" : "rx",
+	        " transfer failed (status ", Hex(e.status), ")",
+	        e.resubmitted ? ", resubmitted" : "");
+
+	if (!e.resubmitted) {
+		error("DMA failed - unable to recover");
 		env.parent().exit(1);
 	}
+}
+
+
+void Main::handle_rx_complete()
+{
+	if (!axidma.rx_transfer_complete())
+		return;
+
+	complete_transfer();
+	kick();
+}
+
+
+void Main::complete_transfer()
+{
+	latencies.add(Trace::timestamp() - start_ts);
+
+	size_t const access_size = runs.value(cur_run).access_size;
+
+	/* release the completed buffer pair */
+	buffers->consume(1, [&] (Dma_buffer_pair &bufs) {
 
-	/* advance tail and initiate next transfer */
-	buffers.advance_tail();
-	queue_next_transfer();
+		/* make DMA-written data visible to the CPU */
+		if (cache == CACHED)
+			Xilinx::Axidma::sync_for_cpu(bufs.rx, access_size);
+
+		/* compare the first access_size bytes of src and dst buffers */
+		if (verify && Genode::memcmp(bufs.tx.local_addr<void>(),
+		                             bufs.rx.local_addr<void>(), access_size)) {
+			error("DMA failed - Data error");
+			env.parent().exit(1);
+		}
+		/* check whether memory content has the expected value */
+		else if (verify && *bufs.rx.local_addr<unsigned>() != rx_counter) {
+			error("Expected ", rx_counter, " but got ", *bufs.rx.local_addr<unsigned>());
+			env.parent().exit(1);
+		}
+	});
+
+	rx_counter++;
+	completed++;
+
+	/* refill the consumed buffer */
 	fill_transfers();
 }
 
 
 void Main::fill_transfers()
 {
-	/* fill all buffers */
-	while (true) {
-		Genode::memset(buffers.head().tx.local_addr<void>(), (uint8_t)counter, cur_access_size);
-		*buffers.head().tx.local_addr<unsigned>() = counter;
+	size_t const access_size = runs.value(cur_run).access_size;
 
-		if (buffers.advance_head())
-			counter++;
-		else
-			break;
-	}
+	/* fill all free buffers */
+	buffers->produce(MAX_QUEUE_DEPTH, [&] (Dma_buffer_pair &bufs) {
+		Genode::memset(bufs.tx.local_addr<void>(), (uint8_t)counter, access_size);
+		*bufs.tx.local_addr<unsigned>() = counter;
+
+		if (cache == CACHED)
+			Xilinx::Axidma::sync_for_device(bufs.tx, access_size);
+
+		counter++;
+	});
 }
 
 
 void Main::queue_next_transfer()
 {
-	/* start transfer */
-	if (buffers.empty()) {
-		warning("unable to queue transfer from empty ring buffer");
-		return;
-	}
+	size_t const buffer_size = runs.value(cur_run).buffer_size;
 
-	Dma_ring_buffer::Dma_buffer_pair bufs = buffers.tail();
-	if (axidma.start_rx_transfer(bufs.rx, cur_buffer_size) != Xilinx::Axidma::Result::OKAY) {
-		error("DMA rx transfer failed");
-		env.parent().exit(1);
-	}
+	/* the buffer pair stays in the ring until the transfer completed */
+	buffers->peek(1, [&] (Dma_buffer_pair &bufs) {
+		start_ts = Trace::timestamp();
 
-	if (axidma.start_tx_transfer(bufs.tx, cur_buffer_size) != Xilinx::Axidma::Result::OKAY) {
-		error("DMA tx transfer failed");
-		env.parent().exit(1);
+		if (axidma.start_rx_transfer(bufs.rx, buffer_size) != Xilinx::Axidma::Result::OKAY) {
+			error("DMA rx transfer failed");
+			env.parent().exit(1);
+		}
+
+		if (axidma.start_tx_transfer(bufs.tx, buffer_size) != Xilinx::Axidma::Result::OKAY) {
+			error("DMA tx transfer failed");
+			env.parent().exit(1);
+		}
+	});
+}
+
+
+void Main::kick()
+{
+	while (completed < runs.value(cur_run).transfers) {
+		if (buffers->empty()) {
+			warning("unable to queue transfer from empty ring buffer");
+			return;
+		}
+
+		queue_next_transfer();
+
+		/* unless completed by polling, completion is signalled by the IRQ */
+		if (!axidma.poll_completion())
+			return;
+
+		complete_transfer();
 	}
+
+	finish_run();
 }
 
 
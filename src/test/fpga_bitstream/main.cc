@@ -0,0 +1,248 @@
+/*
+ * \brief  Test of reading compressed bitstreams
+ * \author agent
+ * \date   2026-10-18
+ *
+ * The test generates .bit files with header lengths of all residues
+ * modulo 4, compresses them in the LZ4 frame format and compares the
+ * bitstream read from the compressed file with the bitstream read from
+ * the uncompressed file. The frames comprise a stored block as well as
+ * compressed blocks with matches.
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/component.h>
+#include <base/heap.h>
+#include <base/attached_ram_dataspace.h>
+
+/* fpga_drv includes */
+#include <bitstream.h>
+
+using namespace Genode;
+
+
+/*
+ * Minimal LZ4 frame encoder that only searches a few fixed match offsets
+ */
+struct Lz4_writer
+{
+	enum { STORED_BLOCK = 1000, BLOCK = 64*1024, LAST_LITERALS = 12 };
+
+	uint8_t *out;
+	size_t   cap;
+	size_t   pos { 0 };
+
+	Lz4_writer(void *out, size_t cap) : out((uint8_t *)out), cap(cap) { }
+
+	void byte(uint8_t b) { if (pos < cap) out[pos++] = b; }
+
+	void le32(uint32_t v) {
+		for (unsigned i = 0; i < 4; i++) byte((uint8_t)(v >> (8*i))); }
+
+	void length(size_t n)
+	{
+		for (; n >= 255; n -= 255) byte(255);
+		byte((uint8_t)n);
+	}
+
+	/* sequence without match if 'match' is 0 */
+	void sequence(uint8_t const *lit, size_t literals, size_t offset, size_t match)
+	{
+		size_t const m = match ? match - 4 : 0;
+
+		byte((uint8_t)((min(literals, (size_t)15) << 4) | min(m, (size_t)15)));
+		if (literals >= 15) length(literals - 15);
+
+		for (size_t i = 0; i < literals; i++) byte(lit[i]);
+
+		if (!match)
+			return;
+
+		byte((uint8_t)offset);
+		byte((uint8_t)(offset >> 8));
+		if (m >= 15) length(m - 15);
+	}
+
+	void compressed_block(uint8_t const *data, size_t begin, size_t end)
+	{
+		size_t const size_pos = pos;
+		le32(0);
+
+		size_t const offsets[] = { 4, 52, 404 };
+
+		size_t lit = begin, i = begin;
+		while (i + LAST_LITERALS < end) {
+			size_t best = 0, best_offset = 0;
+			for (size_t offset : offsets) {
+				if (offset > i) continue;
+				size_t len = 0;
+				while (i + len + LAST_LITERALS < end && data[i + len] == data[i + len - offset])
+					len++;
+				if (len >= 4 && len > best) { best = len; best_offset = offset; }
+			}
+
+			if (!best) { i++; continue; }
+
+			sequence(data + lit, i - lit, best_offset, best);
+			i  += best;
+			lit = i;
+		}
+		sequence(data + lit, end - lit, 0, 0);
+
+		uint32_t const size = (uint32_t)(pos - size_pos - 4);
+		for (unsigned b = 0; b < 4; b++)
+			out[size_pos + b] = (uint8_t)(size >> (8*b));
+	}
+
+	size_t frame(uint8_t const *data, size_t size)
+	{
+		le32(Fpga::Lz4_stream::MAGIC);
+		byte(0x40);   /* version 1, linked blocks, no checksums */
+		byte(0x70);   /* 4 MiB maximum block size */
+		byte(0);      /* header checksum, not verified by the decoder */
+
+		size_t const stored = min(size, (size_t)STORED_BLOCK);
+		le32(0x80000000 | (uint32_t)stored);
+		for (size_t i = 0; i < stored; i++) byte(data[i]);
+
+		for (size_t begin = stored; begin < size; begin += BLOCK)
+			compressed_block(data, begin, min(size, begin + BLOCK));
+
+		le32(0);
+		return pos;
+	}
+};
+
+
+struct Main
+{
+	enum {
+		PAYLOAD_WORDS = 64*1024,
+		FILE_SIZE     = PAYLOAD_WORDS*4 + 256,
+		LZ4_SIZE      = FILE_SIZE + FILE_SIZE/8 + 64,
+		OUT_SIZE      = PAYLOAD_WORDS*4,
+	};
+
+	Env &env;
+
+	Heap heap { env.ram(), env.rm() };
+
+	Attached_ram_dataspace values { env.ram(), env.rm(), PAYLOAD_WORDS*4 };
+	Attached_ram_dataspace file   { env.ram(), env.rm(), FILE_SIZE };
+	Attached_ram_dataspace lz4    { env.ram(), env.rm(), LZ4_SIZE };
+	Attached_ram_dataspace plain  { env.ram(), env.rm(), OUT_SIZE };
+	Attached_ram_dataspace unlz4  { env.ram(), env.rm(), OUT_SIZE };
+
+	unsigned failed { 0 };
+
+	/*
+	 * Write a .bit file whose header has 'pad' additional bytes in the
+	 * design-name field, return the file size
+	 */
+	size_t generate_bit(size_t pad)
+	{
+		uint8_t *f = file.local_addr<uint8_t>();
+		size_t   n = 0;
+
+		uint8_t const prefix[] = { 0x00, 0x09, 0x0f, 0xf0, 0x0f, 0xf0, 0x0f,
+		                           0xf0, 0x0f, 0xf0, 0x00, 0x00, 0x01 };
+		for (uint8_t b : prefix) f[n++] = b;
+
+		auto field = [&] (char key, size_t len) {
+			f[n++] = (uint8_t)key;
+			f[n++] = (uint8_t)(len >> 8);
+			f[n++] = (uint8_t)len;
+			for (size_t i = 0; i < len; i++) f[n++] = (uint8_t)('a' + i % 26);
+		};
+
+		field('a', 8 + pad);
+		field('b', 12);
+		field('c', 11);
+		field('d', 9);
+
+		size_t const length = PAYLOAD_WORDS*4;
+		f[n++] = 0x65;
+		for (int b = 3; b >= 0; b--) f[n++] = (uint8_t)(length >> (8*b));
+
+		/*
+		 * Words in the byte order of .bit files, i.e., big endian. Some
+		 * ranges repeat preceding words for matches in the LZ4 frame.
+		 */
+		uint32_t *v    = values.local_addr<uint32_t>();
+		uint32_t  seed = 0x12345678;
+		for (size_t w = 0; w < PAYLOAD_WORDS; w++) {
+			if      (w < 8)  v[w] = 0xffffffff;
+			else if (w == 8) v[w] = 0xaa995566;
+			else if (w >= 101 && (w / 32) % 3)
+				v[w] = v[w - ((w / 32) % 3 == 1 ? 13 : 101)];
+			else
+				v[w] = seed = seed * 1103515245 + 12345;
+
+			uint8_t *dst = f + n + 4*w;
+			for (int b = 3; b >= 0; b--) *dst++ = (uint8_t)(v[w] >> (8*b));
+		}
+
+		return n + length;
+	}
+
+	size_t read_all(Fpga::Bitstream &bitstream, char *dst, size_t chunk)
+	{
+		size_t offset = 0;
+		for (size_t n; (n = bitstream.read_bitstream(dst + offset, offset, chunk)); )
+			offset += n;
+		return offset;
+	}
+
+	void check(size_t pad, size_t chunk)
+	{
+		size_t const file_size = generate_bit(pad);
+
+		Lz4_writer writer(lz4.local_addr<void>(), LZ4_SIZE);
+		size_t const lz4_size = writer.frame(file.local_addr<uint8_t>(), file_size);
+
+		Fpga::Bitstream &ref = *new (heap) Fpga::Bitstream(file.local_addr<char>(), file_size);
+		Fpga::Bitstream &cmp = *new (heap) Fpga::Bitstream(lz4.local_addr<char>(), lz4_size);
+
+		size_t const ref_size = read_all(ref, plain.local_addr<char>(), chunk);
+		size_t const cmp_size = read_all(cmp, unlz4.local_addr<char>(), chunk);
+
+		bool const ok = ref_size == OUT_SIZE && cmp_size == ref_size
+		             && !memcmp(plain.local_addr<void>(), unlz4.local_addr<void>(), ref_size)
+		             && ref.digest() == cmp.digest();
+
+		log("header length ", ref.offset(), " (", ref.offset() % 4, " mod 4), chunk ",
+		    chunk, ", lz4 ", lz4_size, " of ", file_size, " bytes: ", ok ? "ok" : "FAILED");
+
+		if (!ok) failed++;
+
+		destroy(heap, &ref);
+		destroy(heap, &cmp);
+	}
+
+	Main(Env &env) : env(env)
+	{
+		for (size_t pad = 0; pad < 4; pad++) {
+			check(pad, 4096);
+			check(pad, 12*1024 + 4);
+		}
+
+		if (failed) {
+			error(failed, " checks failed");
+			env.parent().exit(1);
+			return;
+		}
+
+		log("Test finished");
+		env.parent().exit(0);
+	}
+};
+
+
+void Component::construct(Env &env) { static Main main(env); }
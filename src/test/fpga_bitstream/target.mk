@@ -0,0 +1,8 @@
+TARGET   = test-fpga_bitstream
+SRC_CC   = main.cc
+LIBS     = base
+INC_DIR += $(REP_DIR)/src/drivers/fpga
+
+REQUIRES = arm_v7a
+
+CC_OPT += -mfpu=neon
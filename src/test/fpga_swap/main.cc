@@ -0,0 +1,88 @@
+/*
+ * \brief  Benchmark of the bitstream byte-swap kernels
+ * \author agent
+ * \date   2026-10-18
+ *
+ * The test swaps a bitstream-sized buffer with the scalar and the NEON
+ * kernel and compares the throughput with a plain copy, which corresponds
+ * to the cost of staging a RAW bitstream.
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/component.h>
+#include <base/attached_ram_dataspace.h>
+#include <timer_session/connection.h>
+
+/* fpga_drv includes */
+#include <swap.h>
+
+using namespace Genode;
+
+
+struct Main
+{
+	enum { SIZE = 4*1024*1024, WORDS = SIZE / 4, ROUNDS = 10 };
+
+	Env &env;
+
+	Timer::Connection      timer { env };
+	Attached_ram_dataspace src   { env.ram(), env.rm(), SIZE };
+	Attached_ram_dataspace dst   { env.ram(), env.rm(), SIZE };
+	Attached_ram_dataspace ref   { env.ram(), env.rm(), SIZE };
+
+	template <typename FN>
+	void measure(char const *name, FN const &fn)
+	{
+		/* warm up */
+		fn();
+
+		uint64_t const start = timer.elapsed_us();
+		for (unsigned i = 0; i < ROUNDS; i++)
+			fn();
+		uint64_t const us = timer.elapsed_us() - start;
+
+		log(name, ": ", Number_of_bytes(SIZE), " in ", us / ROUNDS, " us (",
+		    us ? ((uint64_t)SIZE * ROUNDS) / us : 0, " MB/s)");
+	}
+
+	Main(Env &env) : env(env)
+	{
+		uint32_t *s = src.local_addr<uint32_t>();
+		uint32_t *d = dst.local_addr<uint32_t>();
+		uint32_t *r = ref.local_addr<uint32_t>();
+
+		for (unsigned i = 0; i < WORDS; i++)
+			s[i] = 0x665599aa ^ (i * 2654435761U);
+
+		measure("memcpy", [&] () { memcpy(d, s, SIZE); });
+		measure("scalar", [&] () { Fpga::swap_words_scalar(r, s, WORDS); });
+
+		/* odd word count checks the scalar tail of the NEON kernel */
+		Fpga::swap_words(d, s, WORDS - 3);
+		Fpga::swap_words_scalar(d + WORDS - 3, s + WORDS - 3, 3);
+
+		if (memcmp(d, r, SIZE)) {
+			error("NEON and scalar kernel differ");
+			env.parent().exit(1);
+			return;
+		}
+
+		if (Fpga::NEON_SWAP_AVAILABLE)
+			measure("neon", [&] () { Fpga::swap_words(d, s, WORDS); });
+		else
+			warning("NEON kernel not available");
+
+		log("Test finished");
+		env.parent().exit(0);
+	}
+};
+
+
+void Component::construct(Env &env) { static Main main(env); }
@@ -0,0 +1,100 @@
+/*
+ * \brief  Test client for the VDMA capture driver
+ * \author agent
+ * \date   2026-10-18
+ *
+ * The test acquires each captured frame, checks the sequence numbers for
+ * gaps and releases the frame after touching its first and last line.
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/component.h>
+#include <base/attached_dataspace.h>
+#include <base/attached_rom_dataspace.h>
+#include <timer_session/connection.h>
+#include <video_capture_session/connection.h>
+
+using namespace Genode;
+
+
+struct Main
+{
+	using Session = Video_capture::Session;
+
+	Env &env;
+
+	Attached_rom_dataspace    config  { env, "config" };
+	Timer::Connection         timer   { env };
+	Video_capture::Connection capture { env };
+
+	Session::Mode const mode { capture.mode() };
+
+	Constructible<Attached_dataspace> frames[Session::MAX_FRAMES] { };
+
+	Signal_handler<Main> frame_handler { env.ep(), *this, &Main::handle_frame };
+
+	/* number of frames after which the test finishes, 0 for infinite */
+	unsigned long const limit { config.xml().attribute_value("frames", 300UL) };
+
+	unsigned long received      { 0 };
+	unsigned long gaps          { 0 };
+	unsigned long last_sequence { 0 };
+	uint64_t      start_us      { 0 };
+	uint64_t      checksum      { 0 };
+
+	void handle_frame()
+	{
+		for (Session::Frame frame = capture.acquire(); frame.valid;
+		     frame = capture.acquire()) {
+
+			if (!received)
+				start_us = timer.elapsed_us();
+			else if (frame.sequence != last_sequence + 1)
+				gaps++;
+
+			last_sequence = frame.sequence;
+			received++;
+
+			uint32_t const *pixels = frames[frame.id]->local_addr<uint32_t const>();
+			checksum += pixels[0] + pixels[(mode.frame_size() / 4) - 1];
+
+			capture.release(frame.id);
+		}
+
+		if (!limit || received < limit)
+			return;
+
+		uint64_t const us = timer.elapsed_us() - start_us;
+		Session::Stats const stats = capture.stats();
+
+		log("received ", received, " frames in ", us / 1000, " ms (",
+		    us ? (received - 1) * 1000000 / us : 0, " fps), ", gaps, " gaps");
+		log("driver: captured=", stats.captured, " delivered=", stats.delivered,
+		    " dropped=", stats.dropped, " late=", stats.late,
+		    " errors=", stats.errors);
+		log("Test finished");
+
+		env.parent().exit(0);
+	}
+
+	Main(Env &env) : env(env)
+	{
+		log("mode ", mode.width, "x", mode.height, " stride=", mode.stride,
+		    " frames=", mode.frames);
+
+		for (unsigned i = 0; i < mode.frames; i++)
+			frames[i].construct(env.rm(), capture.dataspace(i));
+
+		capture.frame_sigh(frame_handler);
+	}
+};
+
+
+void Component::construct(Env &env) { static Main main(env); }
@@ -0,0 +1,3 @@
+TARGET = test-vdma_capture
+SRC_CC = main.cc
+LIBS   = base
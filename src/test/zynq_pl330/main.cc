@@ -0,0 +1,161 @@
+/*
+ * \brief  Test for the PL330 DMA driver
+ * \author agent
+ * \date   2026-10-18
+ *
+ * The test fills a buffer via DMA, copies it into a second buffer by a
+ * chain of copies, and verifies the result. Afterwards, it measures the
+ * throughput of queued copies.
+ */
+
+/*
+ * Copyright (C) 2026 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/component.h>
+#include <base/attached_dataspace.h>
+#include <timer_session/connection.h>
+#include <dma_session/connection.h>
+
+using namespace Genode;
+
+
+struct Main
+{
+	using Job    = Dma::Session::Job;
+	using Chain  = Dma::Session::Chain;
+	using Ticket = Dma::Session::Ticket;
+
+	enum { SIZE = 1024*1024, PAGE = 64*1024, COPIES = 64, QUEUE_DEPTH = 4 };
+
+	Env &env;
+
+	Timer::Connection timer { env };
+	Dma::Connection   dma   { env };
+
+	Dma::Session::Buffer_id const src_id { dma.alloc_buffer(SIZE) };
+	Dma::Session::Buffer_id const dst_id { dma.alloc_buffer(SIZE) };
+
+	Attached_dataspace src { env.rm(), dma.dataspace(src_id) };
+	Attached_dataspace dst { env.rm(), dma.dataspace(dst_id) };
+
+	Signal_handler<Main> completion_handler {
+		env.ep(), *this, &Main::handle_completion };
+
+	enum State { FUNCTIONAL, BENCHMARK } state { FUNCTIONAL };
+
+	Ticket   functional_ticket { 0 };
+	unsigned submitted         { 0 };
+	uint64_t start_us          { 0 };
+
+	Job copy(size_t offset, size_t len) {
+		return Job { Job::COPY, dst_id, offset, src_id, offset, len, 0 }; }
+
+	Job fill(Dma::Session::Buffer_id id, size_t offset, size_t len, uint8_t value) {
+		return Job { Job::FILL, id, offset, id, 0, len, value }; }
+
+	void fail(char const *msg)
+	{
+		error(msg);
+		env.parent().exit(1);
+	}
+
+	void submit_copies()
+	{
+		while (submitted < COPIES &&
+		       submitted - dma.status().completed + functional_ticket < QUEUE_DEPTH) {
+
+			Chain chain { };
+			chain.add(copy(0, SIZE));
+			if (!dma.submit(chain)) {
+				fail("submit failed");
+				return;
+			}
+			submitted++;
+		}
+	}
+
+	void verify()
+	{
+		uint8_t const *s = src.local_addr<uint8_t const>();
+		uint8_t const *d = dst.local_addr<uint8_t const>();
+
+		/* the unaligned tail has been filled with a distinct value */
+		for (size_t i = 0; i < SIZE - 3; i++)
+			if (s[i] != (uint8_t)(i / PAGE + 1) || d[i] != s[i]) {
+				error("mismatch at offset ", Hex(i));
+				fail("DMA test failed - Data error");
+				return;
+			}
+
+		if (d[SIZE - 3] != 0x55 || d[SIZE - 1] != 0x55)
+			fail("DMA test failed - fill error");
+	}
+
+	void handle_completion()
+	{
+		Dma::Session::Status const status = dma.status();
+		if (status.errors) {
+			fail("DMA job failed");
+			return;
+		}
+
+		switch (state) {
+		case FUNCTIONAL:
+			if (status.completed < functional_ticket)
+				return;
+
+			verify();
+			log("DMA copy and fill succeeded");
+
+			state    = BENCHMARK;
+			start_us = timer.elapsed_us();
+			submit_copies();
+			return;
+
+		case BENCHMARK:
+			if (status.completed - functional_ticket < COPIES) {
+				submit_copies();
+				return;
+			}
+
+			uint64_t const us = timer.elapsed_us() - start_us;
+			log("copied ", COPIES, " x ", Number_of_bytes(SIZE), " in ", us, " us (",
+			    us ? ((uint64_t)COPIES * SIZE * 1000) / (us * 1024) : 0, " KB/s)");
+			log("Test finished");
+			env.parent().exit(0);
+			return;
+		}
+	}
+
+	Main(Env &env) : env(env)
+	{
+		dma.completion_sigh(completion_handler);
+
+		/* fill src in 64K pages with distinct values via a chain of fills */
+		for (size_t offset = 0; offset < SIZE; ) {
+			Chain chain { };
+			while (offset < SIZE && chain.add(fill(src_id, offset, PAGE, (uint8_t)(offset / PAGE + 1))))
+				offset += PAGE;
+
+			functional_ticket = dma.submit(chain);
+		}
+
+		/* copy with unaligned lengths, fill an unaligned tail */
+		Chain chain { };
+		chain.add(copy(0, SIZE/2 + 5));
+		chain.add(copy(SIZE/2 + 5, SIZE/2 - 8));
+		chain.add(fill(dst_id, SIZE - 3, 3, 0x55));
+		functional_ticket = dma.submit(chain);
+
+		if (!functional_ticket)
+			fail("submit failed");
+	}
+};
+
+
+void Component::construct(Env &env) { static Main main(env); }
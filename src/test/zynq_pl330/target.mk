@@ -0,0 +1,3 @@
+TARGET = test-zynq_pl330
+SRC_CC = main.cc
+LIBS   = base